@@ -33,9 +33,26 @@
 #include <QQueue>
 #include <QStack>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QDateTime>
+#include <QMetaMethod>
+#include <QtAlgorithms>
+#include <QCryptographicHash>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QPointer>
 #include <QDebug>
 
 #include <QtWidgets/QWidget>
+#include <QtWidgets/QLayout>
+
+#include <string.h>
+#include <queue>
+#include <vector>
+#include <functional>
 
 
 
@@ -50,16 +67,212 @@ struct IterInfo
     QJsonValue     value;
 };
 
+/*
+ * @brief 延迟载入关键字，指定了".lazy": true的JSON对象将在首次访问时才创建
+ */
+static const QLatin1String LazyKeyword(".lazy");
+
+/*! 
+ * 判断一个JSON Value是否为需要延迟载入的JSON对象
+ * @param[in]  jsonValue    JSON Value
+ * @return     是则返回true
+ */
+static inline bool isLazyJsonValue(const QJsonValue& jsonValue)
+{
+    return jsonValue.isObject() && jsonValue.toObject().value(LazyKeyword).toBool();
+}
+
+/*
+ * @brief 决定对象如何被创建的关键字，重新载入时其中任意一个发生变化，对象都需要重新创建
+ */
+static const char* const CreationKeywords[] = 
+{
+    ".type", ".ref", ".copy", ".id",
+#if ENABLE_LEGACY_KEYWORDS
+    "metaType", "id",
+#endif
+};
+
+/*! 
+ * 判断一个Key是否为决定对象如何被创建的关键字
+ * @param[in]  key  JSON中的Key
+ * @return     是则返回true
+ */
+static bool isCreationKeyword(const QString& key)
+{
+    for (size_t i = 0; i < sizeof(CreationKeywords) / sizeof(CreationKeywords[0]); i++)
+    {
+        if (key == QLatin1String(CreationKeywords[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*! 
+ * 收集JSON数据中全部对象的id（.id或旧版本的id），包括嵌套的对象及数组
+ * @param[in]  jsonValue    JSON数据
+ * @param[out] ids          收集到的id列表
+ */
+static void collectJsonIds(const QJsonValue& jsonValue, QStringList& ids)
+{
+    if (jsonValue.isArray())
+    {
+        QJsonArray jsonArray = jsonValue.toArray();
+        for (int i = 0; i < jsonArray.size(); i++) {
+            collectJsonIds(jsonArray.at(i), ids);
+        }
+        return;
+    }
+
+    if (!jsonValue.isObject())
+        return;
+
+    QJsonObject jsonObject = jsonValue.toObject();
+    QJsonValue idValue = jsonObject.value(QLatin1String(".id"));
+    if (idValue.isString()) {
+        ids.push_back(idValue.toString());
+    }
+#if ENABLE_LEGACY_KEYWORDS
+    idValue = jsonObject.value(QLatin1String("id"));
+    if (idValue.isString()) {
+        ids.push_back(idValue.toString());
+    }
+#endif
+
+    QJsonObject::const_iterator iter = jsonObject.constBegin();
+    QJsonObject::const_iterator cend = jsonObject.constEnd();
+    for (; iter != cend; ++iter)
+    {
+        if (iter.value().isObject() || iter.value().isArray()) {
+            collectJsonIds(iter.value(), ids);
+        }
+    }
+}
+
+/*! 
+ * 判断重新载入时能否复用已经载入的对象：对象已经创建，且决定对象如何被创建的关键字均未变化
+ * @param[in]  objectContext    已经载入的对象上下文
+ * @param[in]  jsonObject       新的JSON对象
+ * @return     可以复用则返回true
+ */
+static bool isReusableObject(ObjectContext& objectContext, const QJsonObject& jsonObject)
+{
+    // 尚未载入的延迟载入对象直接重建即可，不需要为了比较而载入
+    if (objectContext.isLazyLoadObjectContext() && 
+        !static_cast<LazyLoadObjectContext&>(objectContext).isMaterialized())
+    {
+        return false;
+    }
+
+    if (!objectContext.value().isObject() || objectContext.qObject() == NULL)
+        return false;
+
+    QJsonObject oldJsonObject = objectContext.value().toObject();
+    for (size_t i = 0; i < sizeof(CreationKeywords) / sizeof(CreationKeywords[0]); i++)
+    {
+        QString key = QLatin1String(CreationKeywords[i]);
+        if (oldJsonObject.value(key) != jsonObject.value(key)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! 
+ * 判断对象上下文的QObject是否由载入过程创建，通过.ref引用的已有对象不属于该对象上下文
+ */
+static bool isCreatedObject(ObjectContext& objectContext)
+{
+    return objectContext.value().isObject() && 
+        !objectContext.value().toObject().contains(QLatin1String(".ref"));
+}
+
+#if ENABLE_LOAD_PROFILING
+/**
+ *  @struct LoadPhaseTimer
+ *  @brief  作用域内的载入阶段计时器，离开作用域时自动恢复之前的载入阶段，外部禁止访问
+ */
+struct LoadPhaseTimer
+{
+    LoadPhaseTimer(const JsonLoader* loader, JsonLoader::LoadPhase phase) 
+        : loader(const_cast<JsonLoader*>(loader))
+        , active(loader->m_loadStatsEnabled)
+        , previousPhase(JsonLoader::OtherPhase)
+    {
+        // 未使能统计时仅需此处的一次判断
+        if (active) {
+            previousPhase = this->loader->switchLoadPhase(phase);
+        }
+    }
+
+    ~LoadPhaseTimer()
+    {
+        if (active) {
+            loader->switchLoadPhase(previousPhase);
+        }
+    }
+
+    JsonLoader*           loader;
+    bool                  active;
+    JsonLoader::LoadPhase previousPhase;
+};
+
+#define LOAD_PHASE_TIMER(_phase)            LoadPhaseTimer loadPhaseTimer(this, JsonLoader::_phase)
+#else
+#define LOAD_PHASE_TIMER(_phase)
+#endif
+
+/**
+ *  @struct LoadScope
+ *  @brief  载入操作的范围，仅在最外层（顶层载入操作）开始及结束时通知JsonLoader，外部禁止访问
+ */
+struct LoadScope
+{
+    LoadScope(JsonLoader* loader) : loader(loader)
+    {
+        if (loader->m_loadDepth++ == 0) {
+            loader->beginLoad();
+        }
+    }
+
+    ~LoadScope()
+    {
+        if (--loader->m_loadDepth == 0) {
+            loader->endLoad();
+        }
+    }
+
+    JsonLoader* loader;
+};
+
+#define LOAD_SCOPE()                        LoadScope loadScope(this)
+
 /**
  * Constructor
  */
 JsonLoader::JsonLoader() : QObject(),
     m_rootObjectContext("JsonLoader", QJsonValue("JsonLoader")),
     m_defaultMetaType(QMetaType::UnknownType),
-    m_propertyDependencyMode(JsonLoader::Default)
+    m_propertyDependencyMode(JsonLoader::Default),
+    m_prefetchEnabled(false),
+    m_asyncLoadId(0),
+    m_templateId(0),
+    m_errorRateLimit(0),
+    m_errorCollectionEnabled(false),
+    m_unresolvedErrorCount(0),
+    m_transactionalConstructionEnabled(false),
+    m_constructionTransaction(NULL),
+    m_loadStatsEnabled(false),
+    m_loadDepth(0)
+#if ENABLE_LOAD_PROFILING
+    , m_currentLoadPhase(JsonLoader::OtherPhase)
+    , m_loadPhaseStart(0)
+#endif
 {
     m_rootObjectContext.setId("JsonLoader");
     m_rootObjectContext.setQObject(this);
+    m_rootObjectContext.setIdScope();
 
     registerObjectCreator(new MetaTypeKeyObjectCreator(this, ".type", ".id"));
     registerObjectCreator(new RefKeyObjectCreator(this, ".ref", ".id"));
@@ -114,9 +327,31 @@ JsonLoader::JsonLoader() : QObject(),
     connect(this, &JsonLoader::error, this, &JsonLoader::reportError);
 #endif
 
-#if ENABLE_MEM_POOL
-    m_objectContextBuffer.reserve(4096);
-#endif
+}
+
+/**
+ * Destructor
+ */
+JsonLoader::~JsonLoader()
+{
+    // 等待全部预读任务结束，它们持有的结果对象由本对象释放
+    m_prefetchPool.waitForDone();
+    m_prefetchResults.clear();
+    m_asyncLoads.clear();
+    m_objectPools.clear();
+
+    // 对象上下文均由内存池持有，根对象上下文仅需断开与它们的联系
+    m_rootObjectContext.clearChildren();
+    m_translations.clear();
+    qDeleteAll(m_lazyObjectContexts);
+    m_lazyObjectContexts.clear();
+    m_lazyOwners.clear();
+    // 对象上下文可能引用快照文件中的数据，需先于映射文件释放
+    m_objectContextPool.release();
+
+    m_jsonDataBuffer.clear();
+    m_jsonDocumentBuffer.clear();
+    unmapJsonFiles();
 }
 
 /*! 
@@ -136,33 +371,36 @@ QVariant JsonLoader::load(
     QList<ObjectContext*>& jsonObjectList
     )
 {
-    if (jsonData.isNull() || jsonData.isEmpty()) 
-    {
-        emit error(EmptyDocument, QString("Empty JSON document detected, key=%1").arg(parentKey));
+    QJsonDocument document = parseJsonDocument(jsonData, parentKey);
+    if (document.isNull())
         return QVariant();
-    }
 
-    QJsonParseError parserError;
-    QJsonDocument document = QJsonDocument::fromJson(jsonData, &parserError);
-    if (parserError.error != QJsonParseError::NoError)
-    {
-        QString dumpString = dumpJsonData(jsonData, parserError.offset);
-        
-        QString errorMessage = parserError.errorString()
-            + QString(", offset=%1: \n").arg(parserError.offset)
-            + dumpString;
-        emit error(parserError.error, errorMessage);
-        // 文档出错后仍然尝试解析
-        //return QVariant();
-    }
+    return load(document, parentContext, parentKey, possibleObjectList, jsonObjectList);
+}
 
+/*! 
+ * 载入已经解析的JSON文档
+ * @param[in]  document             JSON文档
+ * @param[in]  parentContext        该JSON数据的父对象，该JSON中的全部对象将被挂载于父对象下方
+ * @param[in]  parentKey            通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
+ * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+ * @param[in]  jsonObjectList       可能是JSON文件的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+ * @return     加载得到的根对象或根数组
+ */
+QVariant JsonLoader::load(
+    const QJsonDocument& document,
+    ObjectContext& parentContext, 
+    const QString& parentKey,
+    QList<ObjectContext*>& possibleObjectList,
+    QList<ObjectContext*>& jsonObjectList
+    )
+{
     if (document.isNull() || document.isEmpty())
     {
-        emit error(InvalidDocument, "Empty JSON document detected");
+        raiseError(InvalidDocument, "Empty JSON document detected");
         return QVariant();
     }
 
-    
     QJsonValue rootJsonValue;
     if (document.isArray()) {
         rootJsonValue = document.array();
@@ -171,31 +409,79 @@ QVariant JsonLoader::load(
     }
     
     int initialObjectCount = possibleObjectList.size();
-    int count = createObjectContextTree(rootJsonValue, parentContext, parentKey, possibleObjectList);
+    int count = 0;
+    {
+        LOAD_PHASE_TIMER(CreateObjectContextTreePhase);
+        count = createObjectContextTree(rootJsonValue, parentContext, parentKey, possibleObjectList);
+    }
     if (count < 0) {
-        emit error(
+        raiseError(
             ObjectCreatorError,
             QString("Failed to create ObjectContext tree")
             );
     }
     //ObjectContext::dumpObjectContext(parentContext);
 
-    QList<ObjectContext*>::iterator cbegin = possibleObjectList.begin() + initialObjectCount;
+    createQObjects(possibleObjectList, initialObjectCount, jsonObjectList);
+
+#if 0
+    // 待所有对象已经创建完毕后，再统一初始化属性，避免属性中使用了对象名而找不到对象 [3/21/2016 CHENHONGHAO]
+    for (QList<ObjectContext*>::iterator iter = cbegin; iter != cend; ++iter)
+    {
+        qDebug() << (*iter)->toString();
+        bool ok = parseKeys(*(*iter));
+        if (!ok)
+        {
+            // 已经在各层关键节点输出了足够的错误信息，无需再次报错 [3/21/2016 CHENHONGHAO]
+        }
+    }
+#endif
+
+    // FIXME: 此处只返回数组首个元素的指针，应该改进为返回整个数组？ [4/11/2016 CHENHONGHAO]
+    return QVariant::fromValue<QObject*>(possibleObjectList.at(initialObjectCount)->qObject());
+}
+
+/*! 
+ * 为对象上下文列表中新增的对象上下文创建QObject对象，并查找其中嵌套的JSON文件
+ * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表
+ * @param[in]  first                新增的第一个对象上下文在列表中的位置
+ * @param[in]  jsonObjectList       可能是JSON文件的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+ */
+void JsonLoader::createQObjects( QList<ObjectContext*>& possibleObjectList, int first, QList<ObjectContext*>& jsonObjectList )
+{
+    QList<ObjectContext*>::iterator cbegin = possibleObjectList.begin() + first;
     QList<ObjectContext*>::iterator cend = possibleObjectList.end();
+    LOAD_PHASE_TIMER(CreateQObjectPhase);
     for (QList<ObjectContext*>::iterator iter = cbegin; iter != cend; ++iter)
     {
         bool ok = createQObject(*(*iter));
+        if (ok && (*iter)->qObject()) 
+        {
+            LOAD_STATS_COUNT(QObjectCounter);
+            if (isCreatedObject(*(*iter)))
+            {
+                m_createdObjectContexts.insert((*iter)->qObject(), *iter);
+                if (m_constructionTransaction) {
+                    addConstructedObject((*iter)->qObject());
+                }
+            }
+        }
         //if (!ok) qDebug() << (*iter)->value();
         if (!ok && (*iter)->value().type() == QJsonValue::Object) 
         {
-            emit error(
+            raiseError(
                 ObjectCreatorError, 
-                QString("Failed to create object for ObjectContext:%1").arg((*iter)->toString())
+                QString("Failed to create object for ObjectContext:%1"),
+                *iter
                 );
         }
     }
-    //ObjectContext::dumpObjectContext(parentContext);
 
+#if ENABLE_LOAD_PROFILING
+    if (m_loadStatsEnabled) {
+        switchLoadPhase(FindJsonObjectPhase);
+    }
+#endif
     for (QList<ObjectContext*>::iterator iter = cbegin; iter != cend; ++iter)
     {
         bool ok = findJsonObject(*(*iter), jsonObjectList);
@@ -207,23 +493,6 @@ QVariant JsonLoader::load(
 //             possibleObjectList.erase(iter--);
         }
     }
-    //ObjectContext::dumpObjectContext(parentContext);
-
-#if 0
-    // 待所有对象已经创建完毕后，再统一初始化属性，避免属性中使用了对象名而找不到对象 [3/21/2016 CHENHONGHAO]
-    for (QList<ObjectContext*>::iterator iter = cbegin; iter != cend; ++iter)
-    {
-        qDebug() << (*iter)->toString();
-        bool ok = parseKeys(*(*iter));
-        if (!ok)
-        {
-            // 已经在各层关键节点输出了足够的错误信息，无需再次报错 [3/21/2016 CHENHONGHAO]
-        }
-    }
-#endif
-
-    // FIXME: 此处只返回数组首个元素的指针，应该改进为返回整个数组？ [4/11/2016 CHENHONGHAO]
-    return QVariant::fromValue<QObject*>((*cbegin)->qObject());
 }
 
 /*! 
@@ -243,11 +512,13 @@ QVariant JsonLoader::load(
     QList<ObjectContext*>& jsonObjectList
     )
 {
-    QByteArray jsonData = readJsonFile(jsonFile);
-    if (jsonData.isNull())
+    LOAD_SCOPE();
+
+    QJsonDocument document = readJsonDocument(jsonFile);
+    if (document.isNull())
         return QVariant();
     
-    return load(jsonData, parentContext, jsonFile, possibleObjectList, jsonObjectList);
+    return load(document, parentContext, jsonFile, possibleObjectList, jsonObjectList);
 }
 
 /*! 
@@ -258,28 +529,121 @@ QVariant JsonLoader::load(
  * @return     加载得到的根对象或根数组
  */
 QVariant JsonLoader::load( const QByteArray& jsonData, const QString& parentKey, int defaultMetaType )
+{
+    LOAD_SCOPE();
+
+    // 由于直接指定JSON数据流时，parentKey是用户传入的，有重复的可能，
+    // 因此为了保险起见，这里不应使用hash [3/18/2016 CHENHONGHAO]
+    QByteArray jsonDataWithoutComment = removeComments(jsonData);
+
+    QJsonDocument document = parseJsonDocument(jsonDataWithoutComment, parentKey);
+    if (document.isNull())
+        return QVariant();
+
+    return load(document, parentKey, defaultMetaType);
+}
+
+/**
+ *  @struct ConstructionTransaction
+ *  @brief 事务式构建期间新建的对象及被推迟的操作，由最外层的load持有
+ */
+struct ConstructionTransaction
+{
+    QSet<QObject*>                          objects;            //!< 新建的对象
+    QList<QPair<QPointer<QObject>, bool> >  blockedObjects;     //!< 新建的对象及其原有的信号阻塞状态
+    QList<QPointer<QLayout> >               disabledLayouts;    //!< 被禁用的布局
+    QList<QPointer<QWidget> >               suspendedWidgets;   //!< 被暂停刷新的根控件
+    QList<QPointer<QWidget> >               shownWidgets;       //!< 被推迟显示的控件
+};
+
+/*! 
+ * 载入已经解析的JSON文档
+ * @param[in]  document         JSON文档
+ * @param[in]  parentKey        通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
+ * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+ * @return     加载得到的根对象或根数组
+ */
+QVariant JsonLoader::load( const QJsonDocument& document, const QString& parentKey, int defaultMetaType )
+{
+    LOAD_SCOPE();
+
+    return load(document, m_rootObjectContext, parentKey, defaultMetaType);
+}
+
+/*! 
+ * 载入已经解析的JSON文档，并完成嵌套JSON文件的载入及全部对象的属性解析
+ * @param[in]  document         JSON文档
+ * @param[in]  parentContext    该JSON数据的父对象，该JSON中的全部对象将被挂载于父对象下方
+ * @param[in]  parentKey        通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
+ * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+ * @return     加载得到的根对象或根数组
+ */
+QVariant JsonLoader::load( const QJsonDocument& document, ObjectContext& parentContext, const QString& parentKey, int defaultMetaType )
 {
     QList<ObjectContext*> possibleObjectList;
     QList<ObjectContext*> jsonObjectList;
 
+    // 仅最外层的载入开启构建事务，嵌套的载入共享该事务
+    ConstructionTransaction transaction;
+    bool transactional = m_transactionalConstructionEnabled && !m_constructionTransaction;
+    if (transactional) {
+        m_constructionTransaction = &transaction;
+    }
+
     int oldDefaultMetaType = this->defaultMetaType();
     if (defaultMetaType != QMetaType::UnknownType)
         setDefaultMetaType(defaultMetaType);
 
-    // 由于直接指定JSON数据流时，parentKey是用户传入的，有重复的可能，
-    // 因此为了保险起见，这里不应使用hash [3/18/2016 CHENHONGHAO]
-    QByteArray jsonDataWithoutComment = removeComments(jsonData);
-
     QVariant loadedVariant = load(
-        jsonDataWithoutComment, 
-        m_rootObjectContext, 
+        document, 
+        parentContext, 
         parentKey, 
         possibleObjectList, 
         jsonObjectList
         );
 
+    loadNestedJsonFiles(possibleObjectList, jsonObjectList);
+
+    //ObjectContext::dumpObjectContext(m_rootObjectContext);
+
+    if (transactional) {
+        suspendConstructedWidgetUpdates();
+    }
+
+    // 待所有对象已经创建完毕后，再统一初始化属性，避免属性中使用了对象名而找不到对象 [3/21/2016 CHENHONGHAO]
+    parseObjectListKeys(possibleObjectList);
+
+    if (transactional)
+    {
+        commitConstruction();
+        m_constructionTransaction = NULL;
+    }
+
+    //ObjectContext::dumpObjectContext(m_rootObjectContext);
+
+#if JSON_LOADER_DEBUGGING_LEVEL >= 3
+    qDebug() << "================= ObjectContext Tree After Loading" << parentKey << "=================";
+    ObjectContext::dumpObjectContext(m_rootObjectContext);
+#endif
+
+    setDefaultMetaType(oldDefaultMetaType);
+
+    return loadedVariant;
+}
+
+/*! 
+ * 依次载入对象上下文中嵌套的JSON文件，嵌套文件中再次嵌套的文件将被追加到队列中
+ * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表，追加模式
+ * @param[in]  jsonObjectList       可能是JSON文件的对象上下文（ObjectContext）列表，处理完毕后为空
+ */
+void JsonLoader::loadNestedJsonFiles( QList<ObjectContext*>& possibleObjectList, QList<ObjectContext*>& jsonObjectList )
+{
+    LOAD_PHASE_TIMER(NestedFilePhase);
+    // 被嵌套文件替代的对象上下文仅做标记，全部文件载入后再一次性从列表中移除
+    QSet<ObjectContext*> droppedContexts;
     while (!jsonObjectList.isEmpty())
     {
+        LOAD_STATS_COUNT(NestedFileCounter);
         ObjectContext* currentContext = jsonObjectList.front();
         ObjectContext* parentContext  = currentContext->parent();
         QString parentKey = currentContext->parentKey();
@@ -307,21 +671,20 @@ QVariant JsonLoader::load( const QByteArray& jsonData, const QString& parentKey,
         currentContext->removeFromParent();
         
         //freeObjectContext(currentContext);
-        // FIXME: 此处有效率问题，可以考虑先置清除标记，最后批量清除对象
-        possibleObjectList.removeAll(currentContext);
+        droppedContexts.insert(currentContext);
 
-        QByteArray childJsonData = readJsonFile(childJsonPath);
-        if (jsonData.isNull())
+        QJsonDocument childDocument = readJsonDocument(childJsonPath);
+        if (childDocument.isNull())
             continue;
 
-        QVariant loadedObjects = load(childJsonData, *parentContext, parentKey, possibleObjectList, jsonObjectList);
+        QVariant loadedObjects = load(childDocument, *parentContext, parentKey, possibleObjectList, jsonObjectList);
         if (!loadedObjects.isValid())
         {
-            emit error(InvalidRootValue, QString("Failed to load object(s) from ") + childJsonPath);
+            raiseError(InvalidRootValue, QString("Failed to load object(s) from ") + childJsonPath);
         }
         else if (loadedObjects.type() != QMetaType::QObjectStar)
         {
-            emit error(
+            raiseError(
                 InvalidRootValue, 
                 QString("Unsupported data (%1) loaded from %2")
                 .arg(loadedObjects.typeName())
@@ -332,313 +695,1969 @@ QVariant JsonLoader::load( const QByteArray& jsonData, const QString& parentKey,
         {
             QObject* loadedObject = loadedObjects.value<QObject*>();
             currentContext->setQObject(loadedObject);
+
+            // 记录嵌套文件的根对象上下文，重新载入时据此重新读取该文件
+            KeyObjectContextMapConstIter loadedIter = parentContext->constChild(parentKey);
+            if (loadedIter != parentContext->constChildEnd()) {
+                m_nestedJsonFiles.insert(loadedIter->second.back(), childJsonPath);
+                loadedIter->second.back()->setIdScope();
+            }
         }
     }
 
-    //ObjectContext::dumpObjectContext(m_rootObjectContext);
+    if (droppedContexts.isEmpty())
+        return;
 
-#if 1
-    // 待所有对象已经创建完毕后，再统一初始化属性，避免属性中使用了对象名而找不到对象 [3/21/2016 CHENHONGHAO]
-    // Parse properties in possibleObjectList
-    QList<ObjectContext*>::iterator cbegin = possibleObjectList.begin();
-    QList<ObjectContext*>::iterator cend = possibleObjectList.end();
+    // 保持其余对象上下文的顺序不变，属性解析的顺序依赖于此
+    int keptCount = 0;
     int count = possibleObjectList.size();
-    if (m_propertyDependencyMode != ChildrenDependsOnParent)
+    for (int i = 0; i < count; i++)
     {
-        // 父对象依赖于子对象，首先加载子对象，从队列尾部开始
-        QList<ObjectContext*>::iterator iter = cend;
-        while (count--)
-        {
-            // 对象依赖问题：目前并未解析依赖关系树，仅默认先初始化子对象，后初始化父对象，对于大部分场景足矣 [5/6/2016 CHENHONGHAO]
-            parseKeys(*(*--iter));
-            // 已经在各层关键节点输出了足够的错误信息，无需再次报错 [3/21/2016 CHENHONGHAO]
+        ObjectContext* context = possibleObjectList.at(i);
+        if (!droppedContexts.contains(context)) {
+            possibleObjectList[keptCount++] = context;
         }
     }
-    else
+    possibleObjectList.erase(possibleObjectList.begin() + keptCount, possibleObjectList.end());
+}
+
+/*! 
+ * 按照属性依赖关系的顺序，解析全部可能是对象的对象上下文的Key
+ * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表
+ */
+void JsonLoader::parseObjectListKeys( QList<ObjectContext*>& possibleObjectList )
+{
+    LOAD_PHASE_TIMER(ParseKeysPhase);
+    // 待所有对象已经创建完毕后，按照依赖关系依次初始化属性，被引用的对象总是先于引用者初始化
+    QVector<ObjectContext*> sortedObjectList = sortByDependencies(possibleObjectList);
+    int count = sortedObjectList.size();
+    for (int i = 0; i < count; i++)
     {
-        QList<ObjectContext*>::iterator iter = cbegin;
-        while (count--)
-        {
-            parseKeys(*(*iter));
-            ++iter;
-        }
+        parseKeys(*sortedObjectList.at(i));
+        // 已经在各层关键节点输出了足够的错误信息，无需再次报错 [3/21/2016 CHENHONGHAO]
     }
-#endif
-    //ObjectContext::dumpObjectContext(m_rootObjectContext);
+}
 
-#if JSON_LOADER_DEBUGGING_LEVEL >= 3
-    qDebug() << "================= ObjectContext Tree After Loading" << parentKey << "=================";
-    ObjectContext::dumpObjectContext(m_rootObjectContext);
-#endif
+/*! 
+ * 根据父子关系及名称引用建立对象上下文之间的依赖关系图，并按拓扑顺序排列
+ * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表
+ * @return     按依赖关系排序的对象上下文列表
+ */
+QVector<ObjectContext*> JsonLoader::sortByDependencies( const QList<ObjectContext*>& possibleObjectList ) const
+{
+    int count = possibleObjectList.size();
+    bool childrenFirst = m_propertyDependencyMode != ChildrenDependsOnParent;
+
+    // 节点序号即为原有的解析顺序：父对象依赖于子对象时从队列尾部开始，并作为无依赖节点之间的优先级
+    QVector<ObjectContext*> nodes(count);
+    QHash<const Object*, int> nodeIndexes;
+    nodeIndexes.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        nodes[i] = possibleObjectList.at(childrenFirst ? count - 1 - i : i);
+        nodeIndexes.insert(nodes[i], i);
+    }
+
+    // dependents[i]为依赖于节点i的节点，即必须在节点i之后解析的节点
+    QVector< QVector<int> > dependents(count);
+    QVector<int> inDegrees(count, 0);
+    for (int i = 0; i < count; i++)
+    {
+        ObjectContext* node = nodes[i];
+
+        int parentIndex = nodeIndexes.value(node->parent(), -1);
+        if (parentIndex >= 0)
+        {
+            int first = childrenFirst ? i : parentIndex;
+            int second = childrenFirst ? parentIndex : i;
+            dependents[first].push_back(second);
+            ++inDegrees[second];
+        }
+
+        if (!node->value().isObject())
+            continue;
+
+        // 使用.ref引用的原型对象需要先初始化，其Key已经在创建对象时被移除，因此直接查看JSON
+        QList<QPair<ObjectContext*, QString> > references;
+        QJsonValue refValue = node->value().toObject().value(QLatin1String(".ref"));
+        if (refValue.isString()) {
+            references.push_back(qMakePair(node, refValue.toString()));
+        }
+
+        KeyObjectContextMapConstIter keyIter = node->constChildBegin();
+        KeyObjectContextMapConstIter keyEnd = node->constChildEnd();
+        for (; keyIter != keyEnd; ++keyIter)
+        {
+            foreach (ObjectContext* valueContext, keyIter->second)
+            {
+                QJsonValue& value = valueContext->value();
+                if (value.isString()) {
+                    references.push_back(qMakePair(valueContext, value.toString()));
+                }
+            }
+        }
+
+        for (int j = 0; j < references.size(); j++)
+        {
+            // 与ObjectNameStringValueParser及PropertyNameStringValueParser的查找方式一致：
+            // "objectName"引用对象本身，"objectName.propertyName"引用对象的属性（对象名以小写字母开头）
+            const QString& string = references.at(j).second;
+            if (string.isEmpty() || !(string.at(0).isLetter() || string.at(0) == QLatin1Char('_')) || 
+                string.contains(QLatin1Char(' ')) || string.contains(QLatin1Char('`')))
+            {
+                continue;
+            }
+
+            QString objectName = string;
+            int dotIndex = string.indexOf(QLatin1Char('.'));
+            if (dotIndex > 0)
+            {
+                if (!string.at(0).isLower())
+                    continue;
+                objectName = string.left(dotIndex);
+            }
+
+            Object* target = references.at(j).first->findUpwards(objectName);
+            int targetIndex = target ? nodeIndexes.value(target, -1) : -1;
+            if (targetIndex >= 0 && targetIndex != i)
+            {
+                dependents[targetIndex].push_back(i);
+                ++inDegrees[i];
+            }
+        }
+    }
+
+    // 拓扑排序，可同时解析的节点中优先选择原有顺序靠前者
+    std::priority_queue<int, std::vector<int>, std::greater<int> > readyNodes;
+    for (int i = 0; i < count; i++)
+    {
+        if (inDegrees[i] == 0) {
+            readyNodes.push(i);
+        }
+    }
+
+    QVector<ObjectContext*> sortedNodes;
+    sortedNodes.reserve(count);
+    QVector<bool> sorted(count, false);
+    int cursor = 0;
+    while (sortedNodes.size() < count)
+    {
+        int index = 0;
+        if (!readyNodes.empty())
+        {
+            index = readyNodes.top();
+            readyNodes.pop();
+            if (sorted[index])
+                continue;
+        }
+        else
+        {
+            // 存在循环依赖，按原有顺序强制选出下一个节点
+            while (sorted[cursor]) {
+                ++cursor;
+            }
+            index = cursor;
+        }
+
+        sorted[index] = true;
+        sortedNodes.push_back(nodes[index]);
+        foreach (int dependent, dependents[index])
+        {
+            if (--inDegrees[dependent] == 0 && !sorted[dependent]) {
+                readyNodes.push(dependent);
+            }
+        }
+    }
+
+    return sortedNodes;
+}
+
+/*! 
+ * 载入一个延迟载入的对象上下文：创建QObject对象、展开子对象上下文树并解析全部Key
+ * @param[in]  lazyContext  延迟载入的对象上下文
+ * @return     创建了QObject对象则返回true
+ */
+bool JsonLoader::materialize( LazyLoadObjectContext& lazyContext )
+{
+    LOAD_SCOPE();
+
+    QList<ObjectContext*> possibleObjectList;
+    QList<ObjectContext*> jsonObjectList;
+    possibleObjectList.push_back(&lazyContext);
+
+    // 其中嵌套的延迟载入对象在创建对象上下文时重新登记
+    unregisterLazyOwner(&lazyContext);
+
+    {
+        LOAD_PHASE_TIMER(CreateObjectContextTreePhase);
+        QJsonObject jsonObject = lazyContext.value().toObject();
+        QJsonObject::const_iterator iter = jsonObject.constBegin();
+        QJsonObject::const_iterator cend = jsonObject.constEnd();
+        for (; iter != cend; ++iter)
+        {
+            if (iter.key() == LazyKeyword)
+                continue;
+
+            // 子对象同样可以指定延迟载入
+            createObjectContextTree(iter.value(), lazyContext, iter.key(), possibleObjectList, true);
+        }
+    }
+
+    createQObjects(possibleObjectList, 0, jsonObjectList);
+    loadNestedJsonFiles(possibleObjectList, jsonObjectList);
+    parseObjectListKeys(possibleObjectList);
+
+    // 父对象中引用本对象的Key在载入时被推迟解析，此时补充解析，
+    // 同一Key下的其他延迟载入对象（例如同一数组中的元素）将随之一起载入
+    ObjectContext* parentContext = lazyContext.parent();
+    if (parentContext && lazyContext.isParentKeyDeferred())
+    {
+        KeyObjectContextMapConstIter keyIter = parentContext->constChild(lazyContext.parentKey());
+        if (keyIter != parentContext->constChildEnd())
+        {
+            foreach (ObjectContext* context, keyIter->second)
+            {
+                if (context->isLazyLoadObjectContext()) {
+                    static_cast<LazyLoadObjectContext*>(context)->setParentKeyDeferred(false);
+                }
+            }
+            parseKey(*parentContext, keyIter);
+        }
+    }
+
+#if JSON_LOADER_DEBUGGING_LEVEL >= 3
+    qDebug() << "================= ObjectContext Tree After Materializing" << lazyContext.id() << "=================";
+    ObjectContext::dumpObjectContext(lazyContext);
+#endif
+
+    return lazyContext.qObject() != NULL;
+}
+
+/*! 
+ * 载入文件中的JSON数据
+ * @param[in]  jsonFile         JSON文件路径
+ * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+ * @return     加载得到的根对象或根数组
+ * @note       该JSON文件的根对象将指定默认Key为文件路径
+ */
+QVariant JsonLoader::load( const QString& jsonFile, int defaultMetaType )
+{
+    LOAD_SCOPE();
+
+    QJsonDocument document = readJsonDocument(jsonFile);
+    if (document.isNull())
+        return QVariant();
+
+    return load(document, jsonFile, defaultMetaType);
+}
+
+/*! 
+ * 重新载入已经载入的JSON文件，仅应用发生变化的部分
+ * @param[in]  jsonFile         JSON文件路径，必须与载入时使用的路径一致
+ * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+ * @return     重新载入后的根对象
+ */
+QVariant JsonLoader::reload( const QString& jsonFile, int defaultMetaType )
+{
+    KeyObjectContextMapConstIter rootIter = m_rootObjectContext.constChild(jsonFile);
+    bool isRootFile = rootIter != m_rootObjectContext.constChildEnd();
+
+    // 被嵌套的文件在其各个嵌套位置原地更新
+    ObjectContextList reloadedContexts;
+    if (isRootFile)
+    {
+        reloadedContexts = rootIter->second;
+    }
+    else
+    {
+        QHash<ObjectContext*, QString>::const_iterator nestedIter = m_nestedJsonFiles.constBegin();
+        for (; nestedIter != m_nestedJsonFiles.constEnd(); ++nestedIter)
+        {
+            if (nestedIter.value() == jsonFile) {
+                reloadedContexts.push_back(nestedIter.key());
+            }
+        }
+
+        if (reloadedContexts.isEmpty())
+            return load(jsonFile, defaultMetaType);
+    }
+
+    LOAD_SCOPE();
+
+    // 嵌套位置的父对象上下文不会被重建，用于在更新后取得新的根对象
+    ObjectContext* mountContext = isRootFile ? &m_rootObjectContext : reloadedContexts.front()->parent();
+    QString mountKey = isRootFile ? jsonFile : reloadedContexts.front()->parentKey();
+
+    // 丢弃缓冲区中的旧数据（包括全部嵌套文件），已经载入的对象上下文持有各自的JSON数据，不受影响
+    ObjectContextList nestedContexts = nestedJsonFileContexts(reloadedContexts);
+    m_jsonDataBuffer.remove(jsonFile);
+    m_jsonDocumentBuffer.remove(jsonFile);
+    foreach (ObjectContext* nestedContext, nestedContexts)
+    {
+        m_jsonDataBuffer.remove(m_nestedJsonFiles.value(nestedContext));
+        m_jsonDocumentBuffer.remove(m_nestedJsonFiles.value(nestedContext));
+    }
+
+    QJsonValue rootJsonValue;
+    if (isRootFile)
+    {
+        QJsonDocument document = readJsonDocument(jsonFile);
+        if (document.isNull())
+            return QVariant();
+
+        if (document.isArray()) {
+            rootJsonValue = document.array();
+        } else {
+            rootJsonValue = document.object();
+        }
+    }
+
+    int oldDefaultMetaType = this->defaultMetaType();
+    if (defaultMetaType != QMetaType::UnknownType)
+        setDefaultMetaType(defaultMetaType);
+
+    QList<ObjectContext*> possibleObjectList;
+    QList<ObjectContext*> jsonObjectList;
+    QList<QPair<ObjectContext*, QString> > changedKeys;
+    {
+        LOAD_PHASE_TIMER(CreateObjectContextTreePhase);
+        if (isRootFile) {
+            reloadKey(m_rootObjectContext, jsonFile, rootJsonValue, possibleObjectList, changedKeys);
+        }
+        reloadNestedJsonFiles(nestedContexts, possibleObjectList, changedKeys);
+    }
+
+    createQObjects(possibleObjectList, 0, jsonObjectList);
+    loadNestedJsonFiles(possibleObjectList, jsonObjectList);
+    parseObjectListKeys(possibleObjectList);
+
+    // 新增的对象已经初始化完毕，再重新解析发生变化的Key，它们可能引用了新增的对象
+    {
+        LOAD_PHASE_TIMER(ParseKeysPhase);
+        for (int i = 0; i < changedKeys.size(); i++)
+        {
+            // 根对象挂载于JsonLoader下，其Key不是属性
+            ObjectContext* objectContext = changedKeys.at(i).first;
+            if (objectContext == &m_rootObjectContext)
+                continue;
+
+            KeyObjectContextMapConstIter keyIter = objectContext->constChild(changedKeys.at(i).second);
+            if (keyIter != objectContext->constChildEnd()) {
+                parseKey(*objectContext, keyIter);
+            }
+        }
+    }
+
+    setDefaultMetaType(oldDefaultMetaType);
+
+    rootIter = mountContext->constChild(mountKey);
+    if (rootIter == mountContext->constChildEnd())
+        return QVariant();
+
+    // 与load一致，根数组仅返回首个元素
+    const ObjectContextList& rootContexts = rootIter->second;
+    int rootIndex = rootContexts.front()->value().isArray() ? 1 : 0;
+    if (rootIndex >= rootContexts.size())
+        return QVariant();
+
+    return QVariant::fromValue<QObject*>(rootContexts.at(rootIndex)->qObject());
+}
+
+/*! 
+ * 收集指定的对象上下文（包括其自身）之下的全部嵌套JSON文件的根对象上下文
+ * @param[in]  contexts     对象上下文列表
+ * @return     嵌套JSON文件的根对象上下文列表，外层的嵌套文件在前
+ */
+ObjectContextList JsonLoader::nestedJsonFileContexts( const ObjectContextList& contexts ) const
+{
+    ObjectContextList nestedContexts;
+    if (m_nestedJsonFiles.isEmpty())
+        return nestedContexts;
+
+    QQueue<ObjectContext*> contextQ;
+    foreach (ObjectContext* context, contexts) {
+        contextQ.enqueue(context);
+    }
+
+    while (!contextQ.isEmpty())
+    {
+        ObjectContext* context = contextQ.dequeue();
+        if (m_nestedJsonFiles.contains(context)) {
+            nestedContexts.push_back(context);
+        }
+
+        // 尚未载入的延迟载入对象没有子对象上下文，不能触发其载入
+        if (context->isLazyLoadObjectContext() && 
+            !static_cast<LazyLoadObjectContext*>(context)->isMaterialized())
+        {
+            continue;
+        }
+
+        KeyObjectContextMapConstIter childIter = context->constChildBegin();
+        KeyObjectContextMapConstIter childEnd = context->constChildEnd();
+        for (; childIter != childEnd; ++childIter)
+        {
+            foreach (ObjectContext* child, childIter->second) {
+                contextQ.enqueue(child);
+            }
+        }
+    }
+
+    return nestedContexts;
+}
+
+/*! 
+ * 重新载入时，重新读取并比较嵌套的JSON文件：上层文件中嵌套文件的路径未变化时，reloadKey不会发现嵌套文件的修改
+ * @param[in]  nestedContexts       嵌套JSON文件的根对象上下文列表，外层的嵌套文件在前，其缓冲区须已丢弃
+ * @param[in]  possibleObjectList   新创建的可能是对象的对象上下文列表，追加模式，原内容不清空
+ * @param[in]  changedKeys          需要重新解析的Key列表，追加模式，原内容不清空
+ */
+void JsonLoader::reloadNestedJsonFiles( 
+    const ObjectContextList& nestedContexts, 
+    QList<ObjectContext*>& possibleObjectList, 
+    QList<QPair<ObjectContext*, QString> >& changedKeys 
+    )
+{
+    foreach (ObjectContext* nestedContext, nestedContexts)
+    {
+        // 外层文件中被重建的部分已经读取了最新的嵌套文件，其中原有的对象上下文已被释放
+        QHash<ObjectContext*, QString>::const_iterator nestedIter = m_nestedJsonFiles.constFind(nestedContext);
+        if (nestedIter == m_nestedJsonFiles.constEnd() || !nestedContext->parent())
+            continue;
+
+        QString nestedJsonFile = nestedIter.value();
+        QJsonDocument document = readJsonDocument(nestedJsonFile);
+        if (!document.isObject())
+        {
+            raiseError(InvalidRootValue, QString("Failed to load object(s) from ") + nestedJsonFile);
+            continue;
+        }
+
+        // 同一数组中多次嵌套同一文件时，各处共用一个Key，仅能逐个复用
+        ObjectContext* parentContext = nestedContext->parent();
+        QString nestedKey = nestedContext->parentKey();
+        QJsonObject jsonObject = document.object();
+        QList<QPair<ObjectContext*, QString> > nestedChangedKeys;
+        KeyObjectContextMapConstIter keyIter = parentContext->constChild(nestedKey);
+        if (keyIter->second.size() > 1 && isReusableObject(*nestedContext, jsonObject))
+        {
+            reloadObject(*nestedContext, jsonObject, possibleObjectList, nestedChangedKeys);
+        }
+        else
+        {
+            reloadKey(*parentContext, nestedKey, jsonObject, possibleObjectList, nestedChangedKeys);
+
+            // 重建的根对象上下文直接由JSON对象创建，需重新登记
+            keyIter = parentContext->constChild(nestedKey);
+            if (keyIter != parentContext->constChildEnd()) {
+                m_nestedJsonFiles.insert(keyIter->second.back(), nestedJsonFile);
+                keyIter->second.back()->setIdScope();
+            }
+        }
+
+        // 数组中直接嵌套的文件以文件名为Key挂载于数组之下，需要重新解析的是数组所属的Key
+        for (int i = 0; i < nestedChangedKeys.size(); i++)
+        {
+            ObjectContext* changedContext = nestedChangedKeys.at(i).first;
+            if (!changedContext->value().isObject() && changedContext->parent()) {
+                changedKeys.push_back(qMakePair(changedContext->parent(), changedContext->parentKey()));
+            } else {
+                changedKeys.push_back(nestedChangedKeys.at(i));
+            }
+        }
+    }
+}
+
+/*! 
+ * 重新载入时，比较并更新对象上下文的一个Key，无法复用原有对象时重建该Key下的全部对象上下文
+ * @param[in]  parentContext        对象上下文
+ * @param[in]  key                  JSON中的原始Key（可能含有tags）
+ * @param[in]  jsonValue            该Key新的JSON Value
+ * @param[in]  possibleObjectList   新创建的可能是对象的对象上下文列表，追加模式，原内容不清空
+ * @param[in]  changedKeys          需要重新解析的Key列表，追加模式，原内容不清空
+ */
+void JsonLoader::reloadKey( 
+    ObjectContext& parentContext, 
+    const QString& key, 
+    const QJsonValue& jsonValue, 
+    QList<ObjectContext*>& possibleObjectList, 
+    QList<QPair<ObjectContext*, QString> >& changedKeys 
+    )
+{
+    QString pureKey = key;
+    ValueTags unusedKeyTags;
+    parseTags(pureKey, unusedKeyTags);
+
+    KeyObjectContextMapConstIter iter = parentContext.constChild(pureKey);
+    if (iter != parentContext.constChildEnd())
+    {
+        const ObjectContextList& contexts = iter->second;
+        ObjectContext* firstContext = contexts.front();
+
+        if (contexts.size() == 1 && jsonValue.isObject() && isReusableObject(*firstContext, jsonValue.toObject()))
+        {
+            // 对象本身不变，仅更新其内部，引用该对象的属性无需重新解析
+            reloadObject(*firstContext, jsonValue.toObject(), possibleObjectList, changedKeys);
+            return;
+        }
+
+        // 数组首个元素为数组本身，其后依次为各个元素
+        QJsonArray jsonArray = jsonValue.toArray();
+        if (jsonValue.isArray() && firstContext->value().isArray() && contexts.size() == jsonArray.size() + 1)
+        {
+            bool reusable = true;
+            for (int i = 0; i < jsonArray.size() && reusable; i++)
+            {
+                ObjectContext* element = contexts.at(i + 1);
+                QJsonValue elementValue = jsonArray.at(i);
+                reusable = element->value() == elementValue || 
+                    (elementValue.isObject() && isReusableObject(*element, elementValue.toObject()));
+            }
+
+            if (reusable)
+            {
+                for (int i = 0; i < jsonArray.size(); i++)
+                {
+                    ObjectContext* element = contexts.at(i + 1);
+                    QJsonValue elementValue = jsonArray.at(i);
+                    if (element->value() != elementValue) {
+                        reloadObject(*element, elementValue.toObject(), possibleObjectList, changedKeys);
+                    }
+                }
+                firstContext->value() = jsonValue;
+                return;
+            }
+        }
+
+        unloadKey(parentContext, pureKey);
+    }
+
+    if (!jsonValue.isUndefined()) {
+        createObjectContextTree(jsonValue, parentContext, key, possibleObjectList);
+    }
+    changedKeys.push_back(qMakePair(&parentContext, pureKey));
+}
+
+/*! 
+ * 重新载入时，比较并更新一个（可复用的）对象的全部Key
+ * @param[in]  objectContext        对象上下文
+ * @param[in]  jsonObject           该对象新的JSON对象
+ * @param[in]  possibleObjectList   新创建的可能是对象的对象上下文列表，追加模式，原内容不清空
+ * @param[in]  changedKeys          需要重新解析的Key列表，追加模式，原内容不清空
+ */
+void JsonLoader::reloadObject( 
+    ObjectContext& objectContext, 
+    const QJsonObject& jsonObject, 
+    QList<ObjectContext*>& possibleObjectList, 
+    QList<QPair<ObjectContext*, QString> >& changedKeys 
+    )
+{
+    QJsonObject oldJsonObject = objectContext.value().toObject();
+
+    QJsonObject::const_iterator iter = jsonObject.constBegin();
+    QJsonObject::const_iterator cend = jsonObject.constEnd();
+    for (; iter != cend; ++iter)
+    {
+        // 创建相关的关键字已经在复用判定时比较过
+        if (iter.key() == LazyKeyword || isCreationKeyword(iter.key()))
+            continue;
+
+        if (oldJsonObject.value(iter.key()) != iter.value()) {
+            reloadKey(objectContext, iter.key(), iter.value(), possibleObjectList, changedKeys);
+        }
+    }
+
+    QObject* qObject = objectContext.qObject();
+    ValueTags unusedKeyTags;
+    iter = oldJsonObject.constBegin();
+    cend = oldJsonObject.constEnd();
+    for (; iter != cend; ++iter)
+    {
+        if (jsonObject.contains(iter.key()) || iter.key() == LazyKeyword || isCreationKeyword(iter.key()))
+            continue;
+
+        QString pureKey = iter.key();
+        parseTags(pureKey, unusedKeyTags);
+        unloadKey(objectContext, pureKey);
+
+        // 被移除的属性尽可能恢复默认值
+        QMetaProperty property = qObject ? objectContext.property(pureKey) : QMetaProperty();
+        if (property.isValid() && property.isResettable()) {
+            property.reset(qObject);
+        }
+    }
+
+    objectContext.value() = jsonObject;
+}
+
+/*! 
+ * 移除并释放对象上下文的一个Key下的全部对象上下文，并销毁其中载入时创建的QObject对象
+ * @param[in]  parentContext    对象上下文
+ * @param[in]  key              Key（不含tags）
+ */
+void JsonLoader::unloadKey( ObjectContext& parentContext, const QString& key )
+{
+    KeyObjectContextMapConstIter iter = parentContext.constChild(key);
+    if (iter == parentContext.constChildEnd())
+        return;
+
+    ObjectContextList contexts = iter->second;
+    foreach (ObjectContext* context, contexts) {
+        parentContext.removeChild(key, context);
+    }
+
+    unloadObjectContexts(contexts);
+}
+
+/*! 
+ * 释放已经从父对象上下文移除的对象上下文及其子对象上下文，并销毁（或回收至对象池）其中载入时创建的QObject对象
+ * @param[in]  contexts         对象上下文列表
+ */
+void JsonLoader::unloadObjectContexts( const ObjectContextList& contexts )
+{
+    QList<QObject*> createdObjects;
+    ObjectContextList unloadedContexts;
+    QQueue<ObjectContext*> contextQ;
+    foreach (ObjectContext* context, contexts) {
+        contextQ.enqueue(context);
+    }
+
+    while (!contextQ.isEmpty())
+    {
+        ObjectContext* context = contextQ.dequeue();
+        unloadedContexts.push_back(context);
+        m_translations.remove(context);
+        m_nestedJsonFiles.remove(context);
+        context->releaseConnections();
+
+        // 尚未载入的延迟载入对象没有QObject，也没有子对象上下文
+        if (context->isLazyLoadObjectContext() && 
+            !static_cast<LazyLoadObjectContext*>(context)->isMaterialized())
+        {
+            continue;
+        }
+
+        // 通过.ref引用的对象不属于该对象上下文，不能销毁
+        QObject* qObject = context->qObject();
+        if (qObject && isCreatedObject(*context)) 
+        {
+            createdObjects.push_back(qObject);
+            if (m_createdObjectContexts.value(qObject) == context) {
+                m_createdObjectContexts.remove(qObject);
+            }
+        }
+
+        KeyObjectContextMapConstIter childIter = context->constChildBegin();
+        KeyObjectContextMapConstIter childEnd = context->constChildEnd();
+        for (; childIter != childEnd; ++childIter)
+        {
+            foreach (ObjectContext* child, childIter->second) {
+                contextQ.enqueue(child);
+            }
+        }
+    }
+
+    // 子对象先于父对象回收，回收的对象脱离父对象后不会被连带销毁
+    QSet<QObject*> recycledObjects;
+    for (int i = createdObjects.size() - 1; i >= 0; i--)
+    {
+        if (m_objectPools.recycle(createdObjects.at(i))) {
+            recycledObjects.insert(createdObjects.at(i));
+        }
+    }
+
+    // 其余对象可能随父对象一并销毁，因此使用deleteLater，但父对象已被回收时需先脱离，否则会随之被复用
+    foreach (QObject* qObject, createdObjects)
+    {
+        if (recycledObjects.contains(qObject))
+            continue;
+
+        if (!recycledObjects.isEmpty() && recycledObjects.contains(qObject->parent()))
+        {
+            if (qObject->isWidgetType()) {
+                static_cast<QWidget*>(qObject)->setParent(NULL);
+            } else {
+                qObject->setParent(NULL);
+            }
+        }
+        qObject->deleteLater();
+    }
+
+    // 错误记录可能引用了即将释放的对象上下文
+    resolveErrorRecords();
+    foreach (ObjectContext* context, unloadedContexts)
+    {
+        if (context->isLazyLoadObjectContext())
+        {
+            LazyLoadObjectContext* lazyContext = static_cast<LazyLoadObjectContext*>(context);
+            if (!lazyContext->isMaterialized()) {
+                unregisterLazyOwner(lazyContext);
+            }
+            m_lazyObjectContexts.removeOne(lazyContext);
+            delete lazyContext;
+        }
+        else
+        {
+            freeObjectContext(context);
+        }
+    }
+}
+
+/*! 
+ * 卸载一个已经载入的对象及其子对象树，并移除相应的对象上下文
+ * @param[in]  object   载入时创建的对象
+ * @return     未找到该对象的对象上下文时返回false
+ */
+bool JsonLoader::unload( QObject* object )
+{
+    if (object == NULL)
+        return false;
+
+    // 对象的地址可能被销毁后新建的对象复用，因此仍需校验对象上下文
+    ObjectContext* objectContext = m_createdObjectContexts.value(object);
+    if (!objectContext || objectContext->qObject() != object)
+        return false;
+
+    ObjectContext* parentContext = objectContext->parent();
+    objectContext->removeFromParent();
+    unloadObjectContexts(ObjectContextList() << objectContext);
+
+    // 模板实例的作用域仅包含该实例
+    if (parentContext && m_templateScopes.remove(parentContext))
+    {
+        parentContext->removeFromParent();
+        freeObjectContext(parentContext);
+    }
+    return true;
+}
+
+/**
+ *  @struct JsonTemplate
+ *  @brief 已经编译的模板，保存解析得到的JSON文档，供反复创建实例
+ */
+struct JsonTemplate
+{
+    JsonTemplate() : defaultMetaType(QMetaType::UnknownType), instanceCount(0) {}
+
+    QString         jsonFile;               //!< JSON文件路径
+    QJsonDocument   document;               //!< 解析得到的JSON文档，不引用映射文件的内存
+    int             defaultMetaType;        //!< 根对象的默认类型
+    int             instanceCount;          //!< 已经创建的实例个数，用于生成各实例作用域的Key
+};
+
+/*! 
+ * 编译模板：读取、移除注释并解析一次JSON文件
+ * @param[in]  jsonFile         JSON文件路径
+ * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（每个实例仅使用一次）
+ * @return     模板句柄，失败返回0
+ */
+int JsonLoader::compileTemplate( const QString& jsonFile, int defaultMetaType )
+{
+    QJsonDocument document = readJsonDocument(jsonFile);
+    if (document.isNull())
+        return 0;
+
+#if ENABLE_JSON_SNAPSHOT
+    // 快照中的文档直接引用映射文件的内存，快照被替换后映射即被关闭，而模板可能在此之后继续使用，需独立拷贝一份
+    if (!m_snapshotCacheDir.isEmpty()) {
+        document = QJsonDocument::fromBinaryData(document.toBinaryData());
+    }
+#endif
+
+    QSharedPointer<JsonTemplate> jsonTemplate(new JsonTemplate);
+    jsonTemplate->jsonFile        = jsonFile;
+    jsonTemplate->document        = document;
+    jsonTemplate->defaultMetaType = defaultMetaType;
+
+    int templateHandle = ++m_templateId;
+    m_templates.insert(templateHandle, jsonTemplate);
+    return templateHandle;
+}
+
+/*! 
+ * 创建模板的一个实例
+ * @param[in]  templateHandle   模板句柄
+ * @param[in]  parent           实例根对象的父对象，可为NULL
+ * @param[in]  overrides        覆盖模板根对象的Key
+ * @return     实例的根对象，失败返回NULL
+ */
+QObject* JsonLoader::instantiate( int templateHandle, QObject* parent, const QVariantMap& overrides )
+{
+    LOAD_SCOPE();
+
+    QHash<int, QSharedPointer<JsonTemplate> >::const_iterator iter = m_templates.constFind(templateHandle);
+    if (iter == m_templates.constEnd())
+    {
+        raiseError(InvalidTemplate, QString("Invalid template handle: %1").arg(templateHandle));
+        return NULL;
+    }
+    JsonTemplate& jsonTemplate = *iter.value();
+
+    // 覆盖的Key直接写入根对象，子对象的属性可以使用"child.key"的形式
+    QJsonDocument document = jsonTemplate.document;
+    if (!overrides.isEmpty())
+    {
+        if (!document.isObject())
+        {
+            raiseError(
+                UnsupportedFeature, 
+                QString("Template %1 has no root object to override").arg(jsonTemplate.jsonFile)
+                );
+            return NULL;
+        }
+
+        QJsonObject rootObject = document.object();
+        QVariantMap::const_iterator overrideIter = overrides.constBegin();
+        for (; overrideIter != overrides.constEnd(); ++overrideIter)
+        {
+            rootObject.insert(overrideIter.key(), QJsonValue::fromVariant(overrideIter.value()));
+        }
+        document.setObject(rootObject);
+    }
+
+    // 每个实例挂载于独立的作用域下，名称引用向上查找时不会找到其他实例中的同名对象
+    QString scopeKey = QString("%1#%2").arg(jsonTemplate.jsonFile).arg(++jsonTemplate.instanceCount);
+    ObjectContext* scopeContext = allocObjectContext(scopeKey, QJsonValue());
+    scopeContext->setIdScope();
+    m_rootObjectContext.addChild(scopeKey, scopeContext);
+    m_templateScopes.insert(scopeContext);
+
+    QObject* qObject = load(document, *scopeContext, jsonTemplate.jsonFile, jsonTemplate.defaultMetaType).value<QObject*>();
+    if (!qObject)
+    {
+        ObjectContextList instanceContexts;
+        KeyObjectContextMapConstIter childIter = scopeContext->constChildBegin();
+        for (; childIter != scopeContext->constChildEnd(); ++childIter) {
+            instanceContexts += childIter->second;
+        }
+        unloadObjectContexts(instanceContexts);
+
+        m_templateScopes.remove(scopeContext);
+        scopeContext->removeFromParent();
+        freeObjectContext(scopeContext);
+        return NULL;
+    }
+
+    if (parent)
+    {
+        if (qObject->isWidgetType() && parent->isWidgetType()) {
+            static_cast<QWidget*>(qObject)->setParent(static_cast<QWidget*>(parent));
+        } else if (!qObject->isWidgetType()) {
+            qObject->setParent(parent);
+        }
+    }
+
+    return qObject;
+}
+
+/*! 
+ * 释放模板，已经创建的实例不受影响
+ * @param[in]  templateHandle   模板句柄
+ */
+void JsonLoader::releaseTemplate( int templateHandle )
+{
+    m_templates.remove(templateHandle);
+}
+
+/*! 
+ * 设置快照缓存目录
+ * @param[in]  cacheDir     快照缓存目录，为空时禁用快照缓存（默认）
+ * @return     操作成功返回true
+ */
+bool JsonLoader::setSnapshotCacheDir( const QString& cacheDir )
+{
+#if !ENABLE_JSON_SNAPSHOT
+    if (!cacheDir.isEmpty())
+    {
+        raiseError(UnsupportedFeature, QString("JSON snapshot is not supported by this Qt version"));
+        return false;
+    }
+#endif
+    if (!cacheDir.isEmpty() && !QDir().mkpath(cacheDir))
+    {
+        raiseError(InvalidFile, QString("Failed to create snapshot cache directory: ") + cacheDir);
+        return false;
+    }
+
+    m_snapshotCacheDir = cacheDir;
+    return true;
+}
+
+/**
+ * 添加一个全局对象，使该对象可以被本JsonLoader内部的各个QObject对象所引用，绑定信号/槽等
+ * @param[in]    object 全局对象
+ * @return       操作成功返回true    
+ */    
+bool JsonLoader::addGlobalObject(QObject* object)
+{
+    ObjectContext* context = allocObjectContext("global", QJsonValue());
+
+    if (context && object)
+    {
+        context->setQObject(object);
+        context->setId(object->objectName());
+
+        KeyObjectContextMapIter iter = m_rootObjectContext.child("global");
+        m_rootObjectContext.addChild("global", context, iter);
+
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * 移除已经添加的全局对象
+ * @param[in]    object         已经添加的全局对象
+ * @param[in]    removeChildren 是否移除子对象，目前不支持不移除
+ * @return       操作成功返回true
+ */
+bool JsonLoader::removeGlobalObject(QObject* object, bool removeChildren)
+{
+    bool ok = true;
+
+    if (object == NULL || !removeChildren) 
+    {
+        // 目前不支持也没必要不removeChildren
+        return false;
+    }
+
+    KeyObjectContextMapConstIter iter = m_rootObjectContext.constChild("global");
+    if (iter != m_rootObjectContext.constChildEnd())
+    {
+        const ObjectContextList& children = iter->second;
+
+        ObjectContextList::const_iterator iter = children.constBegin();
+        ObjectContextList::const_iterator cend = children.constEnd();
+        for (iter; iter != cend; ++iter)
+        {
+            if ((*iter)->qObject() == object)
+            {
+                if (!(*iter)->removeFromParent()) {
+                    ok = false;
+                }
+            }
+        }
+
+        return ok;
+    }
+
+    return false;
+}
+
+/**
+ * 根据对象名称从上到下查找已经加载的对象
+ * @param[in]    objectName 对象名称
+ * @return       查找结果，未找到则返回NULL
+ */
+QObject* JsonLoader::findObject(const QString& objectName)
+{
+    // 根对象上下文、嵌套文件及模板实例的根对象上下文各自维护id作用域索引，逐个作用域查找
+    Object* object = m_rootObjectContext.findInIdScope(objectName);
+    // 延迟载入对象的子对象尚未创建，载入其所在的延迟载入对象后重新查找（可能逐层载入嵌套的延迟载入对象）
+    while (!object && materializeLazyOwner(objectName)) {
+        object = m_rootObjectContext.findInIdScope(objectName);
+    }
+
+    return object ? object->qObject() : NULL;
+}
+
+/*! 
+ * 在尚未载入的延迟载入对象的JSON中查找指定名称的子对象，找到后载入其所在的延迟载入对象
+ * @param[in]  objectName   对象名称
+ * @return     载入了某个延迟载入对象则返回true
+ */
+bool JsonLoader::materializeLazyOwner( const QString& objectName )
+{
+    // 同名对象按登记的逆序排列，从后向前即按延迟载入对象的创建顺序查找
+    QList<LazyLoadObjectContext*> owners = m_lazyOwners.values(objectName);
+    for (int i = owners.size() - 1; i >= 0; i--)
+    {
+        LazyLoadObjectContext* lazyContext = owners.at(i);
+        if (lazyContext->isMaterialized())
+            continue;
+
+        // 仅载入仍然挂载于对象树中的延迟载入对象
+        Object* ancestor = lazyContext;
+        while (ancestor && ancestor != &m_rootObjectContext) 
+        {
+            ancestor = ancestor->parent();
+        }
+        if (!ancestor)
+            continue;
+
+        lazyContext->materialize();
+        return true;
+    }
+
+    return false;
+}
+
+/*! 
+ * 登记延迟载入对象的JSON中全部对象的id，未找到的名称据此定位需要载入的延迟载入对象
+ * @param[in]  lazyContext  延迟载入的对象上下文
+ */
+void JsonLoader::registerLazyOwner( LazyLoadObjectContext* lazyContext )
+{
+    QStringList ids;
+    collectJsonIds(lazyContext->value(), ids);
+    foreach (const QString& id, ids) {
+        m_lazyOwners.insert(id, lazyContext);
+    }
+}
+
+/*! 
+ * 移除延迟载入对象登记的id，在其载入或释放时调用
+ * @param[in]  lazyContext  延迟载入的对象上下文
+ */
+void JsonLoader::unregisterLazyOwner( LazyLoadObjectContext* lazyContext )
+{
+    QStringList ids;
+    collectJsonIds(lazyContext->value(), ids);
+    foreach (const QString& id, ids) {
+        m_lazyOwners.remove(id, lazyContext);
+    }
+}
+
+/**
+ * 立即载入指定的延迟载入对象（JSON中指定了".lazy": true的对象）及其子对象树
+ * @param[in]    objectName 对象名称
+ * @return       载入得到的对象，未找到或创建失败则返回NULL
+ */
+QObject* JsonLoader::materialize(const QString& objectName)
+{
+    // 延迟载入的对象上下文在首次获取QObject时载入，因此查找即可完成载入
+    return findObject(objectName);
+}
+
+/*! 
+ * 清除载入过程中使用的临时缓冲区等，释放内存
+ * @note 执行本操作需要一定时间，仅用于内存资源受限的设备，并仅应在全部对象已经载入后使用一次
+ */
+void JsonLoader::cleanup()
+{
+    // 释放JsonFileDataHash
+    m_prefetchPool.waitForDone();
+    m_prefetchResults.clear();
+    m_jsonDataBuffer.clear();
+    m_jsonDocumentBuffer.clear();
+
+    // 已经载入的对象上下文仍被查找、翻译、延迟载入及重新载入使用，仅归还内存池中未使用的内存块，
+    // 对象上下文可能引用快照文件中的数据，映射文件同样保留至reset或析构
+    m_objectContextPool.squeeze();
+
+    // 是否需要独立拷贝一份Object的精简版？
+}
+
+/*! 
+ * 释放全部已经载入的对象上下文（不销毁已经创建的QObject对象），全局对象将被保留
+ */
+void JsonLoader::reset()
+{
+    resetObjectContexts();
+}
+
+/*! 
+ * 释放全部对象上下文并重新添加全局对象，内存池的内存块保留用于下一次载入
+ */
+void JsonLoader::resetObjectContexts()
+{
+    resolveErrorRecords();
+
+    QList<QObject*> globalObjects;
+    KeyObjectContextMapConstIter iter = m_rootObjectContext.constChild("global");
+    if (iter != m_rootObjectContext.constChildEnd())
+    {
+        foreach (ObjectContext* context, iter->second)
+        {
+            globalObjects.push_back(context->qObject());
+        }
+    }
+
+    m_rootObjectContext.clearChildren();
+    m_translations.clear();
+    m_nestedJsonFiles.clear();
+    m_createdObjectContexts.clear();
+    qDeleteAll(m_lazyObjectContexts);
+    m_lazyObjectContexts.clear();
+    m_lazyOwners.clear();
+    m_templateScopes.clear();
+
+    // 内存池中的对象上下文批量释放，包括无parent的孤立对象上下文
+    m_objectContextPool.reset();
+    // 已被替换的快照仅被已经释放（或不再可达）的对象上下文引用
+    unmapRetiredJsonFiles();
+
+    foreach (QObject* object, globalObjects)
+    {
+        addGlobalObject(object);
+    }
+}
+
+/**
+ * 注册一个外部的对象创建器，用于语法扩展
+ * @param[in]    creator    对象创建器
+ * @return       操作成功返回true
+ */
+bool JsonLoader::registerObjectCreator( ObjectCreator* creator )
+{
+    if (creator == NULL)
+        return false;
+
+    m_objectCreators.push_back(creator);
+    return true;
+}
+
+/**
+ * 注册一个外部的Key解析器，用于语法扩展
+ * @param[in]    parser    Key解析器
+ * @return       操作成功返回true
+ */
+bool JsonLoader::registerKeyParser( KeyParser* parser )
+{
+    if (parser == NULL)
+        return false;
+
+    m_keyParsers.push_back(parser);
+    m_keyParserTable.clear();
+    return true;
+}
+
+/**
+ * 注册一个外部的ArrayValue解析器，用于语法扩展
+ * @param[in]    parser    ArrayValue解析器
+ * @return       操作成功返回true
+ */
+bool JsonLoader::registerArrayValueParser( ArrayValueParser* parser )
+{
+    if (parser == NULL)
+        return false;
+
+    m_arrayValueParsers.insert(parser->metaType(), parser);
+
+    // 预先建立容器类型到元素类型的映射，载入过程中只读，先注册的解析器优先
+    foreach (const QString& containerTypeName, parser->containerTypeNames())
+    {
+        int elementType = parser->parseArrayElementType(QMetaType::UnknownType, containerTypeName);
+        if (elementType == QMetaType::UnknownType || m_arrayElementTypeNames.contains(containerTypeName))
+            continue;
+
+        m_arrayElementTypeNames.insert(containerTypeName, elementType);
+        // 容器类型可能尚未注册到元对象系统，此时仅能通过类型名称查找
+        int containerType = QMetaType::type(containerTypeName.toLatin1().constData());
+        if (containerType != QMetaType::UnknownType) {
+            m_arrayElementTypes.insert(containerType, elementType);
+        }
+    }
+    return true;
+}
+
+/**
+ * 注册一个外部的StringValue解析器，用于语法扩展
+ * @param[in]    parser    StringValue解析器
+ * @return       操作成功返回true
+ */
+bool JsonLoader::registerStringValueParser( StringValueParser* parser )
+{
+    if (parser == NULL)
+        return false;
+
+    m_stringValueParsers.insert(parser->metaType(), parser);
+    return true;
+}
+
+/*! 
+ * 分配一个对象上下文，使用内存池
+ * @param[in]  parentKey    用于初始化该对象上下文的parentKey
+ * @param[in]  jsonValue    用于初始化该对象上下文的jsonValue
+ * @return     分配得到的对象上下文指针
+ */
+ObjectContext* JsonLoader::allocObjectContext( const QString& parentKey, const QJsonValue& jsonValue )
+{
+    LOAD_STATS_COUNT(ContextCounter);
+
+    return m_objectContextPool.alloc(parentKey, jsonValue);
+}
+
+/*! 
+ * 释放一个对象上下文，归还至内存池
+ * @param[in]  objectContext 分配得到的对象上下文指针
+ * @return     操作成功返回true
+ */
+bool JsonLoader::freeObjectContext( ObjectContext* objectContext )
+{
+    // 错误记录可能引用了即将释放的对象上下文
+    resolveErrorRecords();
+    m_objectContextPool.free(objectContext);
+    return true;
+}
+
+/*! 
+ * 分配一个延迟载入的对象上下文，不使用内存池
+ * @param[in]  parentKey    用于初始化该对象上下文的parentKey
+ * @param[in]  jsonValue    用于初始化该对象上下文的jsonValue，必须为JSON对象
+ * @return     分配得到的对象上下文指针
+ */
+LazyLoadObjectContext* JsonLoader::allocLazyObjectContext( const QString& parentKey, const QJsonValue& jsonValue )
+{
+    LazyLoadObjectContext* lazyContext = new LazyLoadObjectContext(this, parentKey, jsonValue);
+    m_lazyObjectContexts.push_back(lazyContext);
+    registerLazyOwner(lazyContext);
+
+    // 尚未创建QObject，需直接使用JSON中的id，从而能够按名称查找并在首次访问时载入
+    QJsonObject jsonObject = jsonValue.toObject();
+    QJsonValue idValue = jsonObject.value(QLatin1String(".id"));
+#if ENABLE_LEGACY_KEYWORDS
+    if (idValue.isUndefined()) {
+        idValue = jsonObject.value(QLatin1String("id"));
+    }
+#endif
+    if (idValue.isString()) {
+        lazyContext->setId(idValue.toString());
+    }
+
+    return lazyContext;
+}
+
+/*! 
+ * 读取一个JSON文件的全部数据，去除注释并缓存，从而加快多次载入的文件的处理速度
+ * @param[in]  jsonFile JSON文件路径
+ * @return     载入的JSON数据
+ */
+QByteArray JsonLoader::readJsonFile( const QString& jsonFile )
+{
+    LOAD_PHASE_TIMER(ReadJsonFilePhase);
+
+#if JSON_LOADER_DEBUGGING_LEVEL >= 2
+    qDebug() << "Reading JSON file: " << jsonFile;
+#endif
+
+    // 使用文件缓冲区加速多次载入同一JSON文件的场景（包含型被动载入）
+    QHash<QString, QByteArray>::const_iterator bufferIter = m_jsonDataBuffer.constFind(jsonFile);
+    if (bufferIter != m_jsonDataBuffer.constEnd())
+    {
+        LOAD_STATS_COUNT(BufferHitCounter);
+        return bufferIter.value();
+    }
+
+    QByteArray jsonData;
+#if ENABLE_FILE_MAPPING
+    QFile* file = new QFile(jsonFile);
+    if (file->open(QFile::ReadOnly))
+    {
+        // 映射失败（例如某些不支持映射的文件系统）时退化为一次性读取
+        uchar* mapped = file->size() > 0 ? file->map(0, file->size()) : NULL;
+        if (mapped) {
+            jsonData = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), int(file->size()));
+        } else {
+            jsonData = file->readAll();
+            file->close();
+        }
+        if (jsonData.isEmpty()) {
+            raiseError(InvalidFile, QString("Empty JSON file: ") + jsonFile);
+            delete file;
+            return jsonData;
+        }
+    } else {
+        raiseError(InvalidFile, QString("Failed to open JSON file: ") + jsonFile);
+        delete file;
+        return jsonData;
+    }
+
+    // 仅当数据中存在注释时才产生拷贝，否则直接返回映射的文件数据，解析完毕后即关闭（见unmapJsonFile），
+    // 此时不放入缓冲区，再次读取时重新映射即可，避免文件在整个载入期间保持打开
+    QByteArray jsonDataWithoutComment = removeComments(jsonData);
+    if (file->isOpen() && jsonDataWithoutComment.constData() == jsonData.constData()) {
+        delete m_mappedJsonFiles.take(jsonFile);
+        m_mappedJsonFiles.insert(jsonFile, file);
+        return jsonDataWithoutComment;
+    } else {
+        jsonData.clear();
+        delete file;
+    }
+#else
+    QFile file(jsonFile);
+    if (file.open(QFile::ReadOnly))
+    {
+        jsonData = file.readAll();
+        file.close();
+        if (jsonData.isEmpty()) {
+            raiseError(InvalidFile, QString("Empty JSON file: ") + jsonFile);
+            return jsonData;
+        }
+    } else {
+        raiseError(InvalidFile, QString("Failed to open JSON file: ") + jsonFile);
+        return jsonData;
+    }
+
+    QByteArray jsonDataWithoutComment = removeComments(jsonData);
+#endif
+    m_jsonDataBuffer.insert(jsonFile, jsonDataWithoutComment);
+
+#if 0
+    QFile debugFile(jsonFile + ".nocomment");
+    debugFile.open(QFile::WriteOnly);
+    debugFile.write(jsonDataWithoutComment);
+    debugFile.close();
+#endif
+
+    return jsonDataWithoutComment;
+}
+
+/**
+ *  @struct JsonPrefetchResult
+ *  @brief 预读任务的结果，由工作线程写入，完成后释放信号量，由GUI线程取走
+ */
+struct JsonPrefetchResult
+{
+    JsonPrefetchResult() : done(0), fileError(false) {}
+
+    QSemaphore      done;                   //!< 任务完成时释放
+    bool            fileError;              //!< 文件是否无法读取
+    QByteArray      jsonData;               //!< 已经移除注释的JSON数据，用于输出错误信息及填充文件缓冲区
+    QJsonDocument   document;               //!< 解析得到的JSON文档，不引用映射文件的内存
+    QJsonParseError parseError;             //!< 解析错误
+};
+
+/**
+ *  @class JsonPrefetchTask
+ *  @brief 在工作线程中读取、移除注释并解析一个JSON文件，不访问JsonLoader及任何QObject
+ */
+class JsonPrefetchTask : public QRunnable
+{
+public:
+    JsonPrefetchTask(const QString& jsonFile, const QSharedPointer<JsonPrefetchResult>& result) 
+        : m_jsonFile(jsonFile), m_result(result)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QFile file(m_jsonFile);
+        if (file.open(QFile::ReadOnly))
+        {
+            m_result->jsonData = JsonLoader::stripComments(file.readAll());
+            if (!m_result->jsonData.isEmpty()) {
+                m_result->document = QJsonDocument::fromJson(m_result->jsonData, &m_result->parseError);
+            }
+        }
+        else
+        {
+            m_result->fileError = true;
+        }
+
+        m_result->done.release();
+    }
+
+private:
+    QString                             m_jsonFile;
+    QSharedPointer<JsonPrefetchResult>  m_result;
+};
+
+/**
+ *  @struct JsonAsyncLoad
+ *  @brief 异步载入请求，工作线程写入全部文件的解析结果，完成后由GUI线程取走
+ */
+struct JsonAsyncLoad
+{
+    QString                                             jsonFile;           //!< 载入的JSON文件路径
+    int                                                 defaultMetaType;    //!< 默认MetaType
+    QHash<QString, QSharedPointer<JsonPrefetchResult> > results;            //!< 该文件及其嵌套文件的解析结果
+};
+
+/**
+ *  @class JsonAsyncLoadTask
+ *  @brief 在工作线程中解析一个JSON文件及其嵌套的全部JSON文件，完成后通知JsonLoader
+ */
+class JsonAsyncLoadTask : public QRunnable
+{
+public:
+    JsonAsyncLoadTask(JsonLoader* loader, int requestId, const QSharedPointer<JsonAsyncLoad>& request)
+        : m_loader(loader), m_requestId(requestId), m_request(request)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QStringList pendingFiles;
+        pendingFiles.push_back(m_request->jsonFile);
+        while (!pendingFiles.isEmpty())
+        {
+            QString jsonFile = pendingFiles.takeFirst();
+            if (m_request->results.contains(jsonFile))
+                continue;
+
+            QSharedPointer<JsonPrefetchResult> result(new JsonPrefetchResult);
+            JsonPrefetchTask(jsonFile, result).run();
+            m_request->results.insert(jsonFile, result);
 
-    setDefaultMetaType(oldDefaultMetaType);
+            // 与findJsonObject的判定规则一致：以.json结尾的字符串即为嵌套的JSON文件
+            if (result->document.isObject()) {
+                collectJsonFiles(result->document.object(), pendingFiles);
+            } else if (result->document.isArray()) {
+                collectJsonFiles(result->document.array(), pendingFiles);
+            }
+        }
 
-    return loadedVariant;
-}
+        // JsonLoader析构时等待全部任务结束，因此这里m_loader一定有效
+        QMetaObject::invokeMethod(m_loader, "finishAsyncLoad", Qt::QueuedConnection, Q_ARG(int, m_requestId));
+    }
+
+private:
+    static void collectJsonFiles(const QJsonValue& value, QStringList& jsonFiles)
+    {
+        if (value.isString())
+        {
+            QString string = value.toString();
+            if (string.endsWith(QLatin1String(".json"))) {
+                jsonFiles.push_back(string);
+            }
+        }
+        else if (value.isObject())
+        {
+            QJsonObject object = value.toObject();
+            for (QJsonObject::const_iterator iter = object.constBegin(); iter != object.constEnd(); ++iter) {
+                collectJsonFiles(iter.value(), jsonFiles);
+            }
+        }
+        else if (value.isArray())
+        {
+            foreach (const QJsonValue& element, value.toArray()) {
+                collectJsonFiles(element, jsonFiles);
+            }
+        }
+    }
+
+private:
+    JsonLoader*                     m_loader;
+    int                             m_requestId;
+    QSharedPointer<JsonAsyncLoad>   m_request;
+};
 
 /*! 
- * 载入文件中的JSON数据
+ * 异步载入文件中的JSON数据
  * @param[in]  jsonFile         JSON文件路径
  * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
- * @return     加载得到的根对象或根数组
- * @note       该JSON文件的根对象将指定默认Key为文件路径
  */
-QVariant JsonLoader::load( const QString& jsonFile, int defaultMetaType )
+void JsonLoader::loadAsync( const QString& jsonFile, int defaultMetaType )
 {
-    QByteArray jsonData = readJsonFile(jsonFile);
-    if (jsonData.isNull())
-        return QVariant();
+    QSharedPointer<JsonAsyncLoad> request(new JsonAsyncLoad);
+    request->jsonFile        = jsonFile;
+    request->defaultMetaType = defaultMetaType;
 
-    return load(jsonData, jsonFile, defaultMetaType);
+    int requestId = m_asyncLoadId++;
+    m_asyncLoads.insert(requestId, request);
+    m_prefetchPool.start(new JsonAsyncLoadTask(this, requestId, request));
 }
 
-/**
- * 添加一个全局对象，使该对象可以被本JsonLoader内部的各个QObject对象所引用，绑定信号/槽等
- * @param[in]    object 全局对象
- * @return       操作成功返回true    
- */    
-bool JsonLoader::addGlobalObject(QObject* object)
+/*! 
+ * 异步载入的工作线程任务完成后，在本对象所在线程中完成载入
+ * @param[in]  requestId    异步载入请求的序号
+ */
+void JsonLoader::finishAsyncLoad( int requestId )
 {
-    ObjectContext* context = allocObjectContext("global", QJsonValue());
+    QSharedPointer<JsonAsyncLoad> request = m_asyncLoads.take(requestId);
+    if (!request)
+        return;
 
-    if (context && object)
+    // 将解析结果交给预读机制，已经缓冲的文件仍然使用缓冲区，未被使用的结果（例如仅以.json结尾的普通字符串）在载入结束时移除
+    QHash<QString, QSharedPointer<JsonPrefetchResult> >::const_iterator iter = request->results.constBegin();
+    for (; iter != request->results.constEnd(); ++iter)
     {
-        context->setQObject(object);
-        context->setId(object->objectName());
+        if (m_jsonDataBuffer.contains(iter.key()) || m_jsonDocumentBuffer.contains(iter.key()) 
+            || m_prefetchResults.contains(iter.key())) 
+        {
+            continue;
+        }
+        m_prefetchResults.insert(iter.key(), iter.value());
+    }
 
-        KeyObjectContextMapIter iter = m_rootObjectContext.child("global");
-        m_rootObjectContext.addChild("global", context, iter);
+    QVariant result = load(request->jsonFile, request->defaultMetaType);
+    emit loaded(request->jsonFile, result);
+}
 
-        return true;
-    }
-    
-    return false;
+/*! 
+ * 设置是否使能嵌套JSON文件的预读，使能后发现嵌套的JSON文件时，立即在工作线程中读取并解析该文件
+ * @param[in]  enabled  是否使能
+ */
+void JsonLoader::setPrefetchEnabled( bool enabled )
+{
+    m_prefetchEnabled = enabled;
 }
 
-/**
- * 移除已经添加的全局对象
- * @param[in]    object         已经添加的全局对象
- * @param[in]    removeChildren 是否移除子对象，目前不支持不移除
- * @return       操作成功返回true
+/*! 
+ * 在工作线程中预读并解析一个JSON文件，已经缓冲或正在预读的文件将被忽略
+ * @param[in]  jsonFile JSON文件路径
  */
-bool JsonLoader::removeGlobalObject(QObject* object, bool removeChildren)
+void JsonLoader::prefetchJsonFile( const QString& jsonFile )
 {
-    bool ok = true;
+    // 快照缓存的读取已经足够快，不需要预读
+    if (!m_prefetchEnabled || !m_snapshotCacheDir.isEmpty())
+        return;
 
-    if (object == NULL || !removeChildren) 
+    if (m_jsonDataBuffer.contains(jsonFile) || m_prefetchResults.contains(jsonFile))
+        return;
+
+    QSharedPointer<JsonPrefetchResult> result(new JsonPrefetchResult);
+    m_prefetchResults.insert(jsonFile, result);
+    m_prefetchPool.start(new JsonPrefetchTask(jsonFile, result));
+}
+
+/*! 
+ * 等待并取走预读的JSON文档，错误信息在调用线程（GUI线程）中报告
+ * @param[in]  jsonFile JSON文件路径
+ * @return     解析得到的JSON文档，失败时返回空文档
+ */
+QJsonDocument JsonLoader::takePrefetchedDocument( const QString& jsonFile )
+{
+    QSharedPointer<JsonPrefetchResult> result = m_prefetchResults.take(jsonFile);
     {
-        // 目前不支持也没必要不removeChildren
-        return false;
+        LOAD_PHASE_TIMER(ReadJsonFilePhase);
+        result->done.acquire();
     }
 
-    KeyObjectContextMapConstIter iter = m_rootObjectContext.constChild("global");
-    if (iter != m_rootObjectContext.constChildEnd())
+    if (result->fileError)
     {
-        const ObjectContextList& children = iter->second;
+        raiseError(InvalidFile, QString("Failed to open JSON file: ") + jsonFile);
+        return QJsonDocument();
+    }
+    if (result->jsonData.isEmpty())
+    {
+        raiseError(InvalidFile, QString("Empty JSON file: ") + jsonFile);
+        return QJsonDocument();
+    }
 
-        ObjectContextList::const_iterator iter = children.constBegin();
-        ObjectContextList::const_iterator cend = children.constEnd();
-        for (iter; iter != cend; ++iter)
-        {
-            if ((*iter)->qObject() == object)
-            {
-                if (!(*iter)->removeFromParent()) {
-                    ok = false;
-                }
-            }
-        }
+    m_jsonDataBuffer.insert(jsonFile, result->jsonData);
 
-        return ok;
+    if (result->parseError.error != QJsonParseError::NoError)
+    {
+        // 转储错误位置附近的代码需要一定时间，仅在错误消息被使用时进行
+        ErrorRecord record(result->parseError.error, result->parseError.errorString());
+        record.file = jsonFile;
+        record.offset = result->parseError.offset;
+        record.jsonData = result->jsonData;
+        raiseError(record);
     }
 
-    return false;
+    if (result->document.isNull() || result->document.isEmpty())
+    {
+        raiseError(InvalidDocument, "Empty JSON document detected");
+        return QJsonDocument();
+    }
+
+    return result->document;
 }
 
-/**
- * 根据对象名称从上到下查找已经加载的对象
- * @param[in]    objectName 对象名称
- * @return       查找结果，未找到则返回NULL
+/*! 
+ * 关闭一个内存映射的JSON文件
+ * @param[in]  jsonFile     JSON文件路径
  */
-QObject* JsonLoader::findObject(const QString& objectName)
+void JsonLoader::unmapJsonFile( const QString& jsonFile )
 {
-    Object* object = m_rootObjectContext.findDownwards(objectName);
-    return object ? object->qObject() : NULL;
+    if (!m_mappedJsonFiles.isEmpty()) {
+        delete m_mappedJsonFiles.take(jsonFile);
+    }
 }
 
 /*! 
- * 清除载入过程中使用的临时缓冲区等，释放内存
- * @note 执行本操作需要一定时间，仅用于内存资源受限的设备，并仅应在全部对象已经载入后使用一次
+ * 关闭全部内存映射的JSON文件及快照文件
  */
-void JsonLoader::cleanup()
+void JsonLoader::unmapJsonFiles()
 {
-    // TODO:
-    // 移除无parent的孤立ObjectContext
-    // 将有parent的ObjectContext的value置空，释放内存
-    // 释放JsonFileDataHash
-    m_jsonDataBuffer.clear();
-
-    // 是否需要独立拷贝一份Object的精简版？
+    qDeleteAll(m_mappedJsonFiles);
+    m_mappedJsonFiles.clear();
+    unmapRetiredJsonFiles();
 }
 
-/**
- * 注册一个外部的对象创建器，用于语法扩展
- * @param[in]    creator    对象创建器
- * @return       操作成功返回true
+/*! 
+ * 关闭已被替换的快照文件
  */
-bool JsonLoader::registerObjectCreator( ObjectCreator* creator )
+void JsonLoader::unmapRetiredJsonFiles()
 {
-    if (creator == NULL)
-        return false;
-
-    m_objectCreators.push_back(creator);
-    return true;
+    qDeleteAll(m_retiredMappedFiles);
+    m_retiredMappedFiles.clear();
 }
 
-/**
- * 注册一个外部的Key解析器，用于语法扩展
- * @param[in]    parser    Key解析器
- * @return       操作成功返回true
+/*! 
+ * 解析（已经移除注释的）JSON数据，并报告解析错误
+ * @param[in]  jsonData     JSON数据
+ * @param[in]  parentKey    该JSON数据的Key，仅用于输出错误信息
+ * @return     解析得到的JSON文档，失败时返回空文档
  */
-bool JsonLoader::registerKeyParser( KeyParser* parser )
+QJsonDocument JsonLoader::parseJsonDocument( const QByteArray& jsonData, const QString& parentKey )
 {
-    if (parser == NULL)
-        return false;
+    if (jsonData.isNull() || jsonData.isEmpty()) 
+    {
+        raiseError(EmptyDocument, QString("Empty JSON document detected, key=%1").arg(parentKey));
+        return QJsonDocument();
+    }
 
-    m_keyParsers.push_back(parser);
-    return true;
+    QJsonParseError parserError;
+    QJsonDocument document;
+    {
+        LOAD_PHASE_TIMER(ParseJsonPhase);
+        document = QJsonDocument::fromJson(jsonData, &parserError);
+    }
+    if (parserError.error != QJsonParseError::NoError)
+    {
+        // 转储错误位置附近的代码需要一定时间，仅在错误消息被使用时进行
+        ErrorRecord record(parserError.error, parserError.errorString());
+        record.file = parentKey;
+        record.offset = parserError.offset;
+        record.jsonData = jsonData;
+        raiseError(record);
+    }
+
+    if (document.isNull() || document.isEmpty())
+    {
+        raiseError(InvalidDocument, "Empty JSON document detected");
+        return QJsonDocument();
+    }
+
+    return document;
 }
 
-/**
- * 注册一个外部的ArrayValue解析器，用于语法扩展
- * @param[in]    parser    ArrayValue解析器
- * @return       操作成功返回true
+/*! 
+ * 读取并解析一个JSON文件，使能快照缓存时优先使用快照
+ * @param[in]  jsonFile     JSON文件路径
+ * @return     解析得到的JSON文档，失败时返回空文档
  */
-bool JsonLoader::registerArrayValueParser( ArrayValueParser* parser )
+QJsonDocument JsonLoader::readJsonDocument( const QString& jsonFile )
 {
-    if (parser == NULL)
-        return false;
+    bool prefetched = m_prefetchResults.contains(jsonFile);
+    if (m_snapshotCacheDir.isEmpty())
+    {
+        if (prefetched) {
+            return takePrefetchedDocument(jsonFile);
+        }
+        QJsonDocument document = parseJsonDocument(readJsonFile(jsonFile), jsonFile);
+        unmapJsonFile(jsonFile);
+        return document;
+    }
 
-    m_arrayValueParsers.insert(parser->metaType(), parser);
-    return true;
+    QHash<QString, QJsonDocument>::const_iterator bufferIter = m_jsonDocumentBuffer.constFind(jsonFile);
+    if (bufferIter != m_jsonDocumentBuffer.constEnd())
+    {
+        LOAD_STATS_COUNT(BufferHitCounter);
+        return bufferIter.value();
+    }
+
+    // 异步载入时，文件已经在工作线程中解析，直接使用解析结果并更新快照
+    QJsonDocument document = prefetched ? QJsonDocument() : readSnapshot(jsonFile);
+    if (document.isNull())
+    {
+        if (prefetched) {
+            document = takePrefetchedDocument(jsonFile);
+        } else {
+            document = parseJsonDocument(readJsonFile(jsonFile), jsonFile);
+            unmapJsonFile(jsonFile);
+        }
+        if (document.isNull())
+            return document;
+
+        writeSnapshot(jsonFile, document);
+    }
+
+    m_jsonDocumentBuffer.insert(jsonFile, document);
+    return document;
 }
 
+#if ENABLE_JSON_SNAPSHOT
+namespace {
+
 /**
- * 注册一个外部的StringValue解析器，用于语法扩展
- * @param[in]    parser    StringValue解析器
- * @return       操作成功返回true
+ *  @struct SnapshotHeader
+ *  @brief 快照文件头，其后依次为源文件的绝对路径（UTF-8）、对齐填充以及QJsonDocument的二进制数据
  */
-bool JsonLoader::registerStringValueParser( StringValueParser* parser )
+struct SnapshotHeader
 {
-    if (parser == NULL)
+    enum 
+    {
+        Magic   = 0x4E534C4A,               //!< "JLSN"
+        Version = 1
+    };
+
+    quint32 magic;
+    quint32 version;
+    qint64  sourceSize;                     //!< 源文件大小
+    qint64  sourceModified;                 //!< 源文件修改时间（毫秒）
+    char    sourceHash[16];                 //!< 源文件内容的MD5摘要
+    quint32 pathSize;                       //!< 源文件绝对路径的长度
+    quint32 dataOffset;                     //!< 二进制数据相对于文件头的偏移量，按8字节对齐
+};
+
+/*! 
+ * 根据源文件生成快照文件头（不包括dataOffset）
+ * @param[in]  jsonFile     JSON文件路径
+ * @param[out] header       快照文件头
+ * @param[out] sourcePath   源文件的绝对路径
+ * @return     源文件无法读取时返回false
+ */
+bool makeSnapshotHeader(const QString& jsonFile, SnapshotHeader& header, QByteArray& sourcePath)
+{
+    QFile source(jsonFile);
+    if (!source.open(QFile::ReadOnly))
         return false;
 
-    m_stringValueParsers.insert(parser->metaType(), parser);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    uchar* mapped = source.size() > 0 ? source.map(0, source.size()) : NULL;
+    if (mapped) {
+        hash.addData(reinterpret_cast<const char*>(mapped), int(source.size()));
+    } else {
+        hash.addData(&source);
+    }
+    QByteArray digest = hash.result();
+
+    QFileInfo sourceInfo(source);
+    sourcePath = sourceInfo.absoluteFilePath().toUtf8();
+
+    memset(&header, 0, sizeof(header));
+    header.magic          = SnapshotHeader::Magic;
+    header.version        = SnapshotHeader::Version;
+    header.sourceSize     = sourceInfo.size();
+    header.sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+    memcpy(header.sourceHash, digest.constData(), qMin(digest.size(), int(sizeof(header.sourceHash))));
+    header.pathSize       = sourcePath.size();
+    header.dataOffset     = (sizeof(header) + header.pathSize + 7) & ~7u;
     return true;
 }
 
 /*! 
- * 分配一个对象上下文，可能使用内存池
- * @param[in]  parentKey    用于初始化该对象上下文的parentKey
- * @param[in]  jsonValue    用于初始化该对象上下文的jsonValue
- * @return     分配得到的对象上下文指针
+ * 获取源文件对应的快照文件路径
  */
-ObjectContext* JsonLoader::allocObjectContext( const QString& parentKey, const QJsonValue& jsonValue )
+QString snapshotFilePath(const QString& cacheDir, const QByteArray& sourcePath)
 {
-#if ENABLE_MEM_POOL
-    // 使用内存池分配ObjectContext对象
-    m_objectContextBuffer.push_back(ObjectContext(parentKey, jsonValue));
-    return &m_objectContextBuffer.back();
-#else
-    return new ObjectContext(parentKey, jsonValue);
-#endif
+    return cacheDir + QLatin1Char('/') 
+        + QString::fromLatin1(QCryptographicHash::hash(sourcePath, QCryptographicHash::Md5).toHex())
+        + QLatin1String(".jsnap");
+}
+
 }
+#endif
 
 /*! 
- * 释放一个对象上下文，可能使用内存池
- * @param[in]  objectContext 分配得到的对象上下文指针
- * @return     操作成功返回true
+ * 从快照缓存目录中读取JSON文件对应的快照，快照与源文件不一致时视为无效
+ * @param[in]  jsonFile     JSON文件路径
+ * @return     快照中的JSON文档，快照不存在或无效时返回空文档
  */
-bool JsonLoader::freeObjectContext( ObjectContext* objectContext )
+QJsonDocument JsonLoader::readSnapshot( const QString& jsonFile )
 {
-#if ENABLE_MEM_POOL
-    Q_ASSERT_X(false, "JsonLoader::freeObjectContext", "DO NOT call freeObjectContext frequently.");
+#if ENABLE_JSON_SNAPSHOT
+    LOAD_PHASE_TIMER(ReadJsonFilePhase);
+
+    SnapshotHeader header;
+    QByteArray sourcePath;
+    if (!makeSnapshotHeader(jsonFile, header, sourcePath))
+        return QJsonDocument();
+
+    QString snapshotPath = snapshotFilePath(m_snapshotCacheDir, sourcePath);
+    QFile* snapshot = new QFile(snapshotPath);
+    QJsonDocument document;
+    if (snapshot->open(QFile::ReadOnly) && snapshot->size() > qint64(header.dataOffset))
+    {
+        // 快照数据直接由映射的内存页提供，映射的起始地址按页对齐，满足QJsonDocument::fromRawData的对齐要求
+        const uchar* mapped = snapshot->map(0, snapshot->size());
+        SnapshotHeader cachedHeader;
+        if (mapped) 
+        {
+            memcpy(&cachedHeader, mapped, sizeof(cachedHeader));
+        }
+        if (mapped 
+            && memcmp(&cachedHeader, &header, sizeof(header)) == 0
+            && memcmp(mapped + sizeof(header), sourcePath.constData(), header.pathSize) == 0)
+        {
+            document = QJsonDocument::fromRawData(
+                reinterpret_cast<const char*>(mapped + header.dataOffset), 
+                int(snapshot->size() - header.dataOffset)
+                );
+        }
+    }
+
+    if (document.isNull())
+    {
+        delete snapshot;
+        return document;
+    }
+
+#if JSON_LOADER_DEBUGGING_LEVEL >= 2
+    qDebug() << "Using JSON snapshot: " << snapshotPath << "for" << jsonFile;
+#endif
+    // 再次读取同一快照时（例如缓冲区被清除或reload），已经载入的对象上下文可能仍在引用原有的映射，
+    // 因此原有的映射只能在对象上下文释放后关闭
+    QFile* oldSnapshot = m_mappedJsonFiles.take(snapshotPath);
+    if (oldSnapshot) {
+        m_retiredMappedFiles.push_back(oldSnapshot);
+    }
+    m_mappedJsonFiles.insert(snapshotPath, snapshot);
+    return document;
 #else
-    delete objectContext;
+    Q_UNUSED(jsonFile);
+    return QJsonDocument();
 #endif
-    return true;
 }
 
 /*! 
- * 读取一个JSON文件的全部数据，去除注释并缓存，从而加快多次载入的文件的处理速度
- * @param[in]  jsonFile JSON文件路径
- * @return     载入的JSON数据
+ * 将解析得到的JSON文档写入快照缓存目录
+ * @param[in]  jsonFile     JSON文件路径
+ * @param[in]  document     解析得到的JSON文档
+ * @return     操作成功返回true
  */
-QByteArray JsonLoader::readJsonFile( const QString& jsonFile )
+bool JsonLoader::writeSnapshot( const QString& jsonFile, const QJsonDocument& document ) const
 {
-#if JSON_LOADER_DEBUGGING_LEVEL >= 2
-    qDebug() << "Reading JSON file: " << jsonFile;
-#endif
+#if ENABLE_JSON_SNAPSHOT
+    SnapshotHeader header;
+    QByteArray sourcePath;
+    if (!makeSnapshotHeader(jsonFile, header, sourcePath))
+        return false;
 
-    // 使用文件缓冲区加速多次载入同一JSON文件的场景（包含型被动载入）
-    QHash<QString, QByteArray>::const_iterator bufferIter = m_jsonDataBuffer.find(jsonFile);
-    bool foundInBuffer = bufferIter != m_jsonDataBuffer.constEnd();
-    bool multiMapped   = foundInBuffer ? ++bufferIter != m_jsonDataBuffer.constEnd() : false;
-    if (foundInBuffer && !multiMapped)
-    {
-        return (--bufferIter).value();
-    }
+    QByteArray snapshotData;
+    snapshotData.reserve(header.dataOffset);
+    snapshotData.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    snapshotData.append(sourcePath);
+    snapshotData.append(QByteArray(header.dataOffset - snapshotData.size(), '\0'));
 
-    QByteArray jsonData;
-    QFile file(jsonFile);
-    if (file.open(QFile::ReadOnly))
+    // 先写入临时文件再替换，避免其他进程读取到不完整的快照
+    QSaveFile snapshot(snapshotFilePath(m_snapshotCacheDir, sourcePath));
+    if (!snapshot.open(QFile::WriteOnly))
+        return false;
+
+    QByteArray binaryData = document.toBinaryData();
+    if (snapshot.write(snapshotData) != snapshotData.size() || 
+        snapshot.write(binaryData) != binaryData.size())
     {
-        jsonData = file.readAll();
-        file.close();
-        if (jsonData.isEmpty()) {
-            emit error(InvalidFile, QString("Empty JSON file: ") + jsonFile);
-            return jsonData;
-        }
-    } else {
-        emit error(InvalidFile, QString("Failed to open JSON file: ") + jsonFile);
-        return jsonData;
+        snapshot.cancelWriting();
+        return false;
     }
-
-    QByteArray jsonDataWithoutComment = removeComments(jsonData);
-    m_jsonDataBuffer.insert(jsonFile, jsonDataWithoutComment);
-
-#if 0
-    QFile debugFile(jsonFile + ".nocomment");
-    debugFile.open(QFile::WriteOnly);
-    debugFile.write(jsonDataWithoutComment);
-    debugFile.close();
+    return snapshot.commit();
+#else
+    Q_UNUSED(jsonFile);
+    Q_UNUSED(document);
+    return false;
 #endif
-
-    return jsonDataWithoutComment;
 }
 
 /*! 
  * 移除JSON数据中的注释（由于JSON原生语法不支持注释，这里人为引入C-Style注释并在解析前移除）
  * @param[in]  jsonData 含注释的JSON数据
  * @return     不含注释的JSON数据
+ * @note       支持行注释（//）及C-Style的块注释，字符串中的注释符号（例如URL）保持不变；
+ *             注释中的换行符将被保留，从而使解析错误的行号与原文件一致
  */
 QByteArray JsonLoader::removeComments( const QByteArray& jsonData ) const
 {
+    LOAD_PHASE_TIMER(RemoveCommentsPhase);
+
+    return stripComments(jsonData);
+}
+
+/*! 
+ * 移除JSON数据中的注释，不访问JsonLoader的任何状态，可在工作线程中调用
+ * @param[in]  jsonData 含注释的JSON数据
+ * @return     不含注释的JSON数据
+ */
+QByteArray JsonLoader::stripComments( const QByteArray& jsonData )
+{
+    const char* begin = jsonData.constData();
+    const char* end   = begin + jsonData.size();
+
+    // 不含'/'的数据不可能含有注释，直接返回，避免拷贝（memchr通常由C库向量化实现）
+    const char* slash = static_cast<const char*>(memchr(begin, '/', jsonData.size()));
+    if (slash == NULL) {
+        return jsonData;
+    }
+
+    // 输出缓冲区在遇到首个注释时才分配，仅含URL、除号等'/'的数据不需要拷贝
     QByteArray result;
+    char* output = NULL;
 
-    int currentOffset = 0;
-    int commentBegin = 0;
-    while ((commentBegin = jsonData.indexOf("//", currentOffset)) >= 0)
+    const char* current = begin;    // 尚未输出的数据起始位置
+    const char* quote   = NULL;     // 下一个'"'的位置，NULL表示需要重新查找
+    const char* cursor  = begin;    // 当前扫描位置（字符串外部）
+    while (cursor < end)
     {
-        int commentEnd = jsonData.indexOf('\n', commentBegin);
-        result.append(jsonData.mid(currentOffset, commentBegin - currentOffset));
-        currentOffset = commentEnd + 1;
+        // 在字符串外部查找下一个'/'或'"'，两者的位置均被缓存，仅在越过后重新查找
+        if (slash != end && slash < cursor) {
+            slash = static_cast<const char*>(memchr(cursor, '/', end - cursor));
+            if (slash == NULL) slash = end;
+        }
+        if (quote == NULL || (quote != end && quote < cursor)) {
+            quote = static_cast<const char*>(memchr(cursor, '"', end - cursor));
+            if (quote == NULL) quote = end;
+        }
+
+        if (quote < slash)
+        {
+            // 跳过字符串：查找未被转义的'"'（其前方连续的'\\'个数为偶数）
+            const char* stringEnd = quote + 1;
+            while ((stringEnd = static_cast<const char*>(memchr(stringEnd, '"', end - stringEnd))) != NULL)
+            {
+                const char* escape = stringEnd;
+                while (escape > quote && *(escape - 1) == '\\') escape--;
+                if (((stringEnd - escape) & 1) == 0) break;
+                stringEnd++;
+            }
+            cursor = (stringEnd == NULL) ? end : stringEnd + 1;
+            continue;
+        }
+
+        if (slash == end || slash + 1 >= end) {
+            break;
+        }
+
+        const char* commentEnd = NULL;
+        if (slash[1] == '/')
+        {
+            // 行注释：保留结尾的换行符，文件末尾的注释可以没有换行符
+            commentEnd = static_cast<const char*>(memchr(slash + 2, '\n', end - slash - 2));
+            if (commentEnd == NULL) commentEnd = end;
+        }
+        else if (slash[1] == '*')
+        {
+            // 块注释：未闭合的块注释一直延续到文件末尾
+            commentEnd = end;
+            for (const char* star = slash + 2; 
+                (star = static_cast<const char*>(memchr(star, '*', end - star))) != NULL && star + 1 < end; star++)
+            {
+                if (star[1] == '/') {
+                    commentEnd = star + 2;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            // 字符串外部的单独'/'，在JSON中是非法字符，原样保留并交由JSON解析器报错
+            cursor = slash + 1;
+            continue;
+        }
+
+        if (output == NULL)
+        {
+            result = QByteArray(jsonData.size(), Qt::Uninitialized);
+            output = result.data();
+        }
+
+        memcpy(output, current, slash - current);
+        output += slash - current;
+        if (slash[1] == '*')
+        {
+            // 保留块注释中的换行符
+            for (const char* newline = slash + 2; 
+                (newline = static_cast<const char*>(memchr(newline, '\n', commentEnd - newline))) != NULL; newline++)
+            {
+                *output++ = '\n';
+            }
+        }
+        current = cursor = commentEnd;
     }
 
-    if (currentOffset == 0) {
+    if (output == NULL) {
         return jsonData;
     }
 
-    result.append(jsonData.mid(currentOffset));
+    memcpy(output, current, end - current);
+    output += end - current;
+    result.resize(output - result.constData());
     return result;
 }
 
@@ -648,12 +2667,20 @@ QByteArray JsonLoader::removeComments( const QByteArray& jsonData ) const
  * @param[in]  parentContext        该JSON数据的父对象，该JSON中的全部对象将被挂载于父对象下方
  * @param[in]  parentKey            通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
  * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+ * @param[in]  lazyRootAllowed      顶层的JSON对象（或顶层数组的元素）是否允许延迟载入，仅用于延迟载入对象的展开
  * @return     对象上下文（ObjectContext）树新增节点个数
+ * @note       指定了".lazy": true的JSON对象仅创建延迟载入的对象上下文，不展开其子对象，也不放入possibleObjectList
  */
-int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectContext& parentContext, const QString& parentKey, QList<ObjectContext*>& possibleObjectList )
+int JsonLoader::createObjectContextTree( 
+    const QJsonValue& jsonValue, 
+    ObjectContext& parentContext, 
+    const QString& parentKey, 
+    QList<ObjectContext*>& possibleObjectList, 
+    bool lazyRootAllowed 
+    )
 {
     int count = 0;
-    QStringList unusedKeyTags;
+    ValueTags unusedKeyTags;
 
     typedef QPair<QString, QJsonValue> KeyValuePair;
     QQueue< IterInfo > valueQ;
@@ -666,6 +2693,8 @@ int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectCont
     while (!valueQ.isEmpty())
     {
         IterInfo info = valueQ.dequeue();
+        // 仅顶层节点挂载于parentContext下，顶层对象必须立即创建，否则无法返回载入结果
+        bool lazyAllowed = lazyRootAllowed || info.object != &parentContext;
         QString key = info.key;
         parseTags(key, unusedKeyTags);
         //qDebug() << "Info:" << info.key;
@@ -677,6 +2706,13 @@ int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectCont
         if (type != QJsonValue::Array)
         //if (type == QJsonValue::Object || type == QJsonValue::String)
         {
+            if (lazyAllowed && isLazyJsonValue(info.value))
+            {
+                info.object->addChild(key, allocLazyObjectContext(key, info.value));
+                count++;
+                continue;
+            }
+
             ObjectContext *objectContext = allocObjectContext(key, info.value);
             possibleObjectList.push_back(objectContext);
             info.object->addChild(key, objectContext);
@@ -689,6 +2725,9 @@ int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectCont
                 QJsonObject::const_iterator cend = jsonObject.constEnd();
                 for (; iter != cend; ++iter) 
                 {
+                    if (iter.key() == LazyKeyword)
+                        continue;
+
                     IterInfo childInfo;
                     childInfo.key = iter.key();
                     childInfo.value = iter.value();
@@ -716,6 +2755,13 @@ int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectCont
             if (type == QJsonValue::Undefined)
                 continue;
 
+            if (lazyAllowed && isLazyJsonValue(*arrayIter))
+            {
+                childIter = info.object->addChild(key, allocLazyObjectContext(key, *arrayIter), childIter);
+                count++;
+                continue;
+            }
+
             //if (type == QJsonValue::Object || type == QJsonValue::String || type == QJsonValue::Array)
             ObjectContext *objectContext = allocObjectContext(key, *arrayIter);
             possibleObjectList.push_back(objectContext);
@@ -724,7 +2770,7 @@ int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectCont
 
             if (type == QJsonValue::Array)
             {
-                emit error(UnsupportedFeature, "Array-in-array is NOT supported in current version.");
+                raiseError(UnsupportedFeature, "Array-in-array is NOT supported in current version.");
                 //                         IterInfo childInfo;
                 //                         childInfo.key = QString();
                 //                         childInfo.value = *iter;
@@ -740,6 +2786,9 @@ int JsonLoader::createObjectContextTree( const QJsonValue& jsonValue, ObjectCont
                 QJsonObject::const_iterator objCend = jsonObject.constEnd();
                 for (; objIter != objCend; ++objIter) 
                 {
+                    if (objIter.key() == LazyKeyword)
+                        continue;
+
                     IterInfo childInfo;
                     childInfo.key = objIter.key();
                     childInfo.value = objIter.value();
@@ -783,7 +2832,7 @@ bool JsonLoader::createQObject( ObjectContext& objectContext )
     // ObjectCreator需要处理QString等非QObject子类对象的场景，在这些场景下，不需要提前创建对象
     if (ok && objectContext.qObject() == NULL)
     {
-        emit error(ObjectCreatorError, "One of the Object-Creators returned true but didn't create an object");
+        raiseError(ObjectCreatorError, "One of the Object-Creators returned true but didn't create an object");
         ok = false;
     }
 #endif
@@ -815,6 +2864,7 @@ bool JsonLoader::findJsonObject( ObjectContext& objectContext, QList<ObjectConte
             if (objectContext.parentKey() != QLatin1String(".ref"))
             {
                 jsonObjectList.push_back(&objectContext);
+                prefetchJsonFile(string);
                 return true;
             }
         }
@@ -847,12 +2897,22 @@ bool JsonLoader::parseKey( ObjectContext& objectContext, KeyObjectContextMapCons
     }
 #endif
 
-    foreach (KeyParser* keyParser, m_keyParsers)
+    // 同一个key匹配的解析器是确定的，首次遇到该key时按注册顺序筛选并缓存，此后仅需一次查找
+    QHash<QString, QList<KeyParser*> >::const_iterator tableIter = m_keyParserTable.constFind(key);
+    if (tableIter == m_keyParserTable.constEnd())
     {
-        if (!keyParser->matches(key)) {
-            continue;
+        QList<KeyParser*> matchedParsers;
+        foreach (KeyParser* keyParser, m_keyParsers)
+        {
+            if (keyParser->matches(key)) {
+                matchedParsers.push_back(keyParser);
+            }
         }
+        tableIter = m_keyParserTable.insert(key, matchedParsers);
+    }
 
+    foreach (KeyParser* keyParser, tableIter.value())
+    {
         if (keyParser->parse(&objectContext, iter)) 
         {
             parsed = true;
@@ -862,11 +2922,13 @@ bool JsonLoader::parseKey( ObjectContext& objectContext, KeyObjectContextMapCons
 
     if (!parsed) 
     {
-        emit error(
+        const ObjectContextList& values = iter->second;
+        raiseError(
             KeyParserError, 
-            QString("Failed to parse key:%1 for Object:%2")
-            .arg(key)
-            .arg(objectContext.toString())
+            QString("Failed to parse key:%1 with value:%2 for Object:%3"),
+            &objectContext,
+            key,
+            values.isEmpty() ? QString() : values.front()->toString()
             );
 
         // 以后可能还会在其他地方引用到此对象 [3/17/2016 CHENHONGHAO]
@@ -889,6 +2951,9 @@ bool JsonLoader::parseKeys( ObjectContext& objectContext )
 
     for (iter; iter != cend; ++iter)
     {
+        if (!m_lazyObjectContexts.isEmpty() && deferLazyKey(iter))
+            continue;
+
         if (!parseKey(objectContext, iter)) {
             allParsed = false;
         }
@@ -898,53 +2963,94 @@ bool JsonLoader::parseKeys( ObjectContext& objectContext )
 }
 
 /*! 
- * 解析Key或者Value中的tags
+ * 若一个Key的值中含有尚未载入的延迟载入对象，则推迟该Key的解析，直到这些对象被载入
+ * @param[in]  iter     对象上下文的Key迭代器
+ * @return     需要推迟解析则返回true
+ */
+bool JsonLoader::deferLazyKey( KeyObjectContextMapConstIter iter )
+{
+    bool deferred = false;
+
+    foreach (ObjectContext* context, iter->second)
+    {
+        if (!context->isLazyLoadObjectContext())
+            continue;
+
+        LazyLoadObjectContext* lazyContext = static_cast<LazyLoadObjectContext*>(context);
+        if (!lazyContext->isMaterialized())
+        {
+            lazyContext->setParentKeyDeferred(true);
+            deferred = true;
+        }
+    }
+
+    return deferred;
+}
+
+/*! 
+ * 解析Key或者Value中的tags，tag由成对的反引号包围，多余的反引号（最左侧的一个）保留在字符串中
  * @param[inout] string JSON中的原始字符串，以及裁减后的字符串输出
- * @param[in]    tags   解析得到的tags
- * @return       解析得到的tag个数
+ * @param[in]    tags   解析得到的tags，追加模式，原内容不清空
+ * @return       解析得到的tag个数，失败返回-1
  */
-int JsonLoader::parseTags(QString& valueString, QStringList& tags) const
+int JsonLoader::parseTags(QString& valueString, ValueTags& tags) const
 {
-    bool ok = true;
+    const QChar* chars  = valueString.constData();
+    int          length = valueString.length();
 
-    // 分割所有tags，从右向左解析
-    QString pureValueString = valueString;
-    int length = valueString.length();
-    int offset = length - 1;
-    while (offset >= 0)
+    // 绝大多数Key和Value不含tag，仅扫描一遍且不分配内存
+    int tickCount = 0;
+    for (int i = 0; i < length; i++)
     {
-        int startIndex = -1;
-        int endIndex   = -1;
+        if (chars[i] == QLatin1Char('`')) {
+            tickCount++;
+        }
+    }
+    if (tickCount == 0) {
+        return 0;
+    }
+
+    // 反引号从右向左配对，个数为奇数时最左侧的反引号不参与配对，其位于开头时视为格式错误
+    bool unpaired = (tickCount & 1) != 0;
+    bool ok       = !(unpaired && chars[0] == QLatin1Char('`'));
 
-        endIndex = valueString.lastIndexOf(QLatin1Char('`'), offset);
-        if (endIndex > 0) {
-            startIndex = valueString.lastIndexOf(QLatin1Char('`'), endIndex - 1);
-        } 
-        else if (endIndex == 0) 
+    int count        = 0;
+    int segmentStart = 0;
+    int tagStart     = -1;
+    QString pureValueString;
+    pureValueString.reserve(length);
+    for (int i = 0; i < length; i++)
+    {
+        if (chars[i] != QLatin1Char('`'))
+            continue;
+
+        if (unpaired)
         {
-            ok = false;
-            break;
+            unpaired = false;
+            continue;
         }
-        if (startIndex < 0 || endIndex < 0)
+        if (tagStart < 0)
         {
-            // 已经解析完所有tag
-            break;
+            tagStart = i;
+            continue;
         }
 
-        QString tag = valueString.mid(startIndex + 1, endIndex - startIndex - 1);
-        if (tag.length() > 0)
+        // 空的tag保留在字符串中
+        if (i > tagStart + 1)
         {
-            tags.push_back(tag);
-            pureValueString.remove(startIndex, endIndex - startIndex + 1);
+            pureValueString.append(chars + segmentStart, tagStart - segmentStart);
+            tags.add(QStringRef(&valueString, tagStart + 1, i - tagStart - 1));
+            segmentStart = i + 1;
+            count++;
         }
-
-        offset = startIndex - 1;
+        tagStart = -1;
     }
+    pureValueString.append(chars + segmentStart, length - segmentStart);
 
     // 输出移除tags的纯字符串
     valueString = pureValueString;
 
-    return ok ? tags.size() : -1;
+    return ok ? count : -1;
 }
 
 /*! 
@@ -1037,10 +3143,10 @@ QVariant JsonLoader::parseValue( ObjectContext& objectContext, int metaTypeHint
     
     bool parsed = false;
     QString string = jsonValue.toString();
-    QStringList tags;
+    ValueTags tags;
     if (parseTags(string, tags) < 0)
     {
-        emit error(
+        raiseError(
             StringValueParserError,
             "Failed to parse string tags for: " + string
             );
@@ -1104,7 +3210,7 @@ QVariant JsonLoader::parseValue( ObjectContext& objectContext, int metaTypeHint
             }
             else
             {
-                emit error(
+                raiseError(
                     StringValueParserError, 
                     QString("Failed to convert String[%1] to %2.")
                     .arg(string)
@@ -1116,7 +3222,7 @@ QVariant JsonLoader::parseValue( ObjectContext& objectContext, int metaTypeHint
 
     if (!parsed)
     {
-        emit error(
+        raiseError(
             StringValueParserError, 
             QString("Failed to parse String value: %1 with metaTypeHint:%2(%3)")
             .arg(string)
@@ -1136,6 +3242,21 @@ QVariant JsonLoader::parseValue( ObjectContext& objectContext, int metaTypeHint
  */
 int JsonLoader::parseArrayElementType( int propertyMetaTypeId, const QString& propertyMetaTypeName )
 {
+    // 首先查找注册解析器时建立的映射（只读，可在多线程中使用）
+    if (propertyMetaTypeId != QMetaType::UnknownType)
+    {
+        QHash<int, int>::const_iterator iter = m_arrayElementTypes.constFind(propertyMetaTypeId);
+        if (iter != m_arrayElementTypes.constEnd()) {
+            return iter.value();
+        }
+    }
+
+    QHash<QString, int>::const_iterator nameIter = m_arrayElementTypeNames.constFind(propertyMetaTypeName);
+    if (nameIter != m_arrayElementTypeNames.constEnd()) {
+        return nameIter.value();
+    }
+
+    // 无法枚举容器类型的解析器（例如自定义的正则表达式），只能逐一尝试
     foreach (ArrayValueParser* arrayValueParser, m_arrayValueParsers)
     {
         int result = arrayValueParser->parseArrayElementType(propertyMetaTypeId, propertyMetaTypeName);
@@ -1198,7 +3319,7 @@ QVariant JsonLoader::parseArrayValue( const QVariantList& valueArray, int metaTy
 
     if (!parsed)
     {
-        emit error(
+        raiseError(
             ArrayValueParserError, 
             QString("Failed to parse array value with metaTypeHint:%1").arg(metaTypeHint)
             );
@@ -1219,6 +3340,253 @@ void JsonLoader::reportError( int code, const QString& message ) const
 }
 #endif
 
+/*! 
+ * 报告一个错误：计数，并根据配置收集该错误记录或发送error信号
+ * @param[in]  record   错误记录
+ */
+void JsonLoader::raiseError( const ErrorRecord& record ) const
+{
+    int count = ++m_errorCounts[record.code];
+    if (m_errorRateLimit > 0 && count > m_errorRateLimit)
+        return;
+
+    if (m_errorCollectionEnabled)
+    {
+        m_errorRecords.push_back(record);
+        if (record.context) {
+            m_unresolvedErrorCount++;
+        }
+        // JSON数据可能直接引用内存映射的文件，收集时需要独立拷贝
+        if (!record.jsonData.isEmpty()) {
+            m_errorRecords.back().jsonData = QByteArray(record.jsonData.constData(), record.jsonData.size());
+        }
+        return;
+    }
+
+    // 无人接收error信号时不需要格式化错误消息
+    static const QMetaMethod errorSignal = QMetaMethod::fromSignal(&JsonLoader::error);
+    if (!isSignalConnected(errorSignal))
+        return;
+
+    emit error(record.code, errorMessage(record));
+}
+
+/*! 
+ * 格式化一条错误记录
+ * @param[in]  record   错误记录
+ * @return     错误消息
+ */
+QString JsonLoader::errorMessage( const ErrorRecord& record ) const
+{
+    // 一次性替换全部占位符，Key、Value等替换进来的文本中的%N不会被再次替换
+    QString message = record.message;
+    if (record.context) {
+        message = message.arg(record.key, record.value, record.context->toString());
+    } else if (!record.object.isNull()) {
+        message = message.arg(record.key, record.value, record.object);
+    }
+
+    if (record.offset >= 0 && !record.jsonData.isEmpty())
+    {
+        message += QString(", offset=%1: \n").arg(record.offset);
+        message += dumpJsonData(record.jsonData, record.offset);
+    }
+
+    return message;
+}
+
+/*! 
+ * 生成错误报告，包括各错误码的发生次数及已经收集的全部错误消息
+ * @return     错误报告
+ */
+QString JsonLoader::errorReport() const
+{
+    QString report;
+
+    QList<int> codes = m_errorCounts.keys();
+    qSort(codes);
+    foreach (int code, codes)
+    {
+        int count = m_errorCounts.value(code);
+        report += QString("JSON error [%1]: %2 time(s)").arg(code).arg(count);
+        if (m_errorRateLimit > 0 && count > m_errorRateLimit) {
+            report += QString(", %1 not reported").arg(count - m_errorRateLimit);
+        }
+        report += QLatin1Char('\n');
+    }
+
+    foreach (const ErrorRecord& record, m_errorRecords)
+    {
+        report += QString("JSON error [%1]: ").arg(record.code);
+        if (!record.file.isEmpty()) {
+            report += record.file + QLatin1String(": ");
+        }
+        report += errorMessage(record);
+        report += QLatin1Char('\n');
+    }
+
+    return report;
+}
+
+/*! 
+ * 清除错误计数及已经收集的错误记录
+ */
+void JsonLoader::clearErrors()
+{
+    m_errorCounts.clear();
+    m_errorRecords.clear();
+    m_unresolvedErrorCount = 0;
+}
+
+/*! 
+ * 在对象上下文被释放之前，格式化已经收集的错误记录中引用了对象上下文的部分
+ */
+void JsonLoader::resolveErrorRecords()
+{
+    if (m_unresolvedErrorCount == 0)
+        return;
+
+    QList<ErrorRecord>::iterator iter = m_errorRecords.begin();
+    QList<ErrorRecord>::iterator cend = m_errorRecords.end();
+    for (; iter != cend; ++iter)
+    {
+        if (iter->context)
+        {
+            // 描述为空时仍需替换占位符，因此不能保留空（null）字符串
+            iter->object = iter->context->toString();
+            if (iter->object.isNull()) {
+                iter->object = QLatin1String("");
+            }
+            iter->context = NULL;
+        }
+    }
+    m_unresolvedErrorCount = 0;
+}
+
+/*! 
+ * 事务式构建期间，登记一个新建的对象：阻塞其信号，禁用其布局（如果是QLayout）
+ * @param[in]  qObject  新建的对象
+ */
+void JsonLoader::addConstructedObject( QObject* qObject )
+{
+    ConstructionTransaction* transaction = m_constructionTransaction;
+    if (!transaction || !qObject || transaction->objects.contains(qObject))
+        return;
+
+    transaction->objects.insert(qObject);
+    transaction->blockedObjects.push_back(qMakePair(QPointer<QObject>(qObject), qObject->blockSignals(true)));
+
+    // 禁用的布局忽略子控件的增删等事件，提交时只需重新计算一次
+    QLayout* layout = qobject_cast<QLayout*>(qObject);
+    if (layout && layout->isEnabled())
+    {
+        layout->setEnabled(false);
+        transaction->disabledLayouts.push_back(layout);
+    }
+}
+
+/*! 
+ * 事务式构建期间，新建对象的全部对象创建完毕后，暂停其中根控件的刷新
+ */
+void JsonLoader::suspendConstructedWidgetUpdates()
+{
+    ConstructionTransaction* transaction = m_constructionTransaction;
+    if (!transaction)
+        return;
+
+    // 父控件也是新建的控件会随父控件一并暂停刷新
+    int count = transaction->blockedObjects.size();
+    for (int i = 0; i < count; i++)
+    {
+        QObject* qObject = transaction->blockedObjects.at(i).first;
+        if (!qObject || !qObject->isWidgetType())
+            continue;
+
+        QWidget* widget = static_cast<QWidget*>(qObject);
+        QWidget* parentWidget = widget->parentWidget();
+        if (!widget->updatesEnabled() || (parentWidget && transaction->objects.contains(parentWidget)))
+            continue;
+
+        widget->setUpdatesEnabled(false);
+        transaction->suspendedWidgets.push_back(widget);
+    }
+}
+
+/*! 
+ * 事务式构建期间，判断是否推迟一个属性的写入，目前仅推迟新建控件的显示（visible为true）
+ * @param[in]  qObject  对象
+ * @param[in]  property 属性
+ * @param[in]  value    属性值
+ * @return     推迟写入返回true
+ */
+bool JsonLoader::deferPropertyWrite( QObject* qObject, const QMetaProperty& property, const QVariant& value )
+{
+    ConstructionTransaction* transaction = m_constructionTransaction;
+    if (!transaction || !qObject->isWidgetType() || qstrcmp(property.name(), "visible") != 0)
+        return false;
+
+    if (!transaction->objects.contains(qObject))
+        return false;
+
+    // 以最后一次写入为准
+    QPointer<QWidget> widget = static_cast<QWidget*>(qObject);
+    transaction->shownWidgets.removeAll(widget);
+    if (!value.toBool())
+        return false;
+
+    transaction->shownWidgets.push_back(widget);
+    return true;
+}
+
+/*! 
+ * 提交事务式构建：恢复信号、启用布局、显示控件，最后恢复根控件的刷新
+ */
+void JsonLoader::commitConstruction()
+{
+    ConstructionTransaction* transaction = m_constructionTransaction;
+    if (!transaction)
+        return;
+
+    QList<QPair<QPointer<QObject>, bool> >::const_iterator objectIter = transaction->blockedObjects.constBegin();
+    QList<QPair<QPointer<QObject>, bool> >::const_iterator objectEnd = transaction->blockedObjects.constEnd();
+    for (; objectIter != objectEnd; ++objectIter)
+    {
+        if (objectIter->first) {
+            objectIter->first->blockSignals(objectIter->second);
+        }
+    }
+
+    foreach (const QPointer<QLayout>& layout, transaction->disabledLayouts)
+    {
+        if (layout)
+        {
+            layout->setEnabled(true);
+            layout->invalidate();
+        }
+    }
+
+    // 先显示子控件，再显示窗口，窗口显示时一次性完成布局
+    foreach (const QPointer<QWidget>& widget, transaction->shownWidgets)
+    {
+        if (widget && !widget->isWindow()) {
+            widget->setVisible(true);
+        }
+    }
+    foreach (const QPointer<QWidget>& widget, transaction->shownWidgets)
+    {
+        if (widget && widget->isWindow()) {
+            widget->setVisible(true);
+        }
+    }
+
+    foreach (const QPointer<QWidget>& widget, transaction->suspendedWidgets)
+    {
+        if (widget) {
+            widget->setUpdatesEnabled(true);
+        }
+    }
+}
+
 QString JsonLoader::dumpJsonData(const QByteArray& data, int offset) const
 {
     int length = data.length();
@@ -1255,6 +3623,154 @@ QString JsonLoader::dumpJsonData(const QByteArray& data, int offset) const
     return QString::fromUtf8(dumpData);
 }
 
+/*! 
+ * 使能/禁用载入统计
+ * @param[in]  loadStatsEnabled 是否使能
+ * @return     操作成功返回true
+ */
+bool JsonLoader::setLoadStatsEnabled( bool loadStatsEnabled )
+{
+#if !ENABLE_LOAD_PROFILING
+    if (loadStatsEnabled)
+    {
+        raiseError(UnsupportedFeature, QString("Load profiling is not compiled in (ENABLE_LOAD_PROFILING)"));
+        return false;
+    }
+#endif
+    m_loadStatsEnabled = loadStatsEnabled;
+    return true;
+}
+
+/*! 
+ * 获取最近一次顶层载入操作中指定阶段的耗时
+ * @param[in]  phase    载入阶段
+ * @return     该阶段的累计耗时（纳秒）
+ */
+qint64 JsonLoader::loadPhaseTime( LoadPhase phase ) const
+{
+    if (phase < 0 || phase >= LoadPhaseCount)
+        return 0;
+
+    return m_loadStats.phaseTime[phase];
+}
+
+/*! 
+ * 获取载入阶段的名称，用于输出计时结果
+ * @param[in]  phase    载入阶段
+ * @return     阶段名称
+ */
+const char* JsonLoader::loadPhaseName( LoadPhase phase )
+{
+    static const char* const names[LoadPhaseCount] = 
+    {
+        "other",
+        "readJsonFile",
+        "removeComments",
+        "fromJson",
+        "createObjectContextTree",
+        "createQObject",
+        "findJsonObject",
+        "nestedFiles",
+        "parseKeys"
+    };
+
+    if (phase < 0 || phase >= LoadPhaseCount)
+        return "unknown";
+
+    return names[phase];
+}
+
+/*! 
+ * 开始一次顶层载入操作
+ */
+void JsonLoader::beginLoad()
+{
+#if ENABLE_LOAD_PROFILING
+    beginLoadProfiling();
+#endif
+}
+
+/*! 
+ * 结束一次顶层载入操作
+ */
+void JsonLoader::endLoad()
+{
+    // 预读结果只在安排预读的载入操作中使用，此后文件可能被修改，未被取走的结果不再保留
+    // 仍在运行的预读任务持有结果的引用，移除后由任务结束时释放
+    m_prefetchResults.clear();
+
+#if ENABLE_LOAD_PROFILING
+    endLoadProfiling();
+#endif
+}
+
+#if ENABLE_LOAD_PROFILING
+/*! 
+ * 开始一次顶层载入操作的分阶段计时，清除上一次的计时结果
+ */
+void JsonLoader::beginLoadProfiling()
+{
+    m_currentLoadPhase = OtherPhase;
+    if (!m_loadStatsEnabled)
+        return;
+
+    m_loadStats = LoadStats();
+    m_loadPhaseClock.start();
+    m_loadPhaseStart = 0;
+}
+
+/*! 
+ * 结束一次顶层载入操作的分阶段计时
+ */
+void JsonLoader::endLoadProfiling()
+{
+    if (!m_loadStatsEnabled)
+        return;
+
+    qint64 now = m_loadPhaseClock.nsecsElapsed();
+    m_loadStats.phaseTime[m_currentLoadPhase] += now - m_loadPhaseStart;
+    m_loadStats.totalTime = now;
+    m_loadPhaseStart = now;
+    m_currentLoadPhase = OtherPhase;
+
+#if JSON_LOADER_DEBUGGING_LEVEL >= 2
+    qDebug() << "================= JsonLoader Load Profiling:" << now / 1000 << "us =================";
+    for (int i = 0; i < LoadPhaseCount; i++)
+    {
+        qDebug() << "\t" << loadPhaseName(LoadPhase(i)) << ":" << m_loadStats.phaseTime[i] / 1000 << "us";
+    }
+    qDebug() << "\tcontexts:" << m_loadStats.counters[ContextCounter]
+             << "objects:"    << m_loadStats.counters[QObjectCounter]
+             << "properties:" << m_loadStats.counters[PropertyCounter]
+             << "files:"      << m_loadStats.counters[NestedFileCounter]
+             << "bufferHits:" << m_loadStats.counters[BufferHitCounter];
+#endif
+
+    emit loadFinished(m_loadStats);
+}
+
+/*! 
+ * 切换当前的载入阶段，并将已经经过的时间计入之前的阶段
+ * @param[in]  phase    新的载入阶段
+ * @return     之前的载入阶段
+ */
+JsonLoader::LoadPhase JsonLoader::switchLoadPhase( LoadPhase phase )
+{
+    LoadPhase previousPhase = m_currentLoadPhase;
+    if (!m_loadStatsEnabled || m_loadDepth <= 0 || phase == previousPhase) {
+        // 未使能统计、不在载入过程中（例如translateAllStrings），或者阶段未发生变化，不需要计时
+        return previousPhase;
+    }
+
+    qint64 now = m_loadPhaseClock.nsecsElapsed();
+    m_loadStats.phaseTime[previousPhase] += now - m_loadPhaseStart;
+    m_loadPhaseStart = now;
+    m_currentLoadPhase = phase;
+
+    return previousPhase;
+}
+#endif
+
 
 /*! 
  * 添加指定的对象上下文对应的一条翻译信息（一一对应）
@@ -1301,10 +3817,10 @@ int JsonLoader::translateAllStrings()
             KeyObjectContextMapConstIter keyIter = parent->constChild(parentKey);
             if (!parseKey(*parent, keyIter))
             {
-                emit error(
+                raiseError(
                     TranslationError, 
-                    QString("Failed to translate string: %1")
-                    .arg(translation->toString())
+                    QString("Failed to translate string: %1"),
+                    translation
                     );
                 continue;
             }
@@ -1347,7 +3863,7 @@ bool JsonLoader::createTranslationFile( const QString& tsFile ) const
         QJsonValue& value = translation->value();
         QString source = value.toString();
 
-        QStringList tags;
+        ValueTags tags;
         parseTags(source, tags);
 
         // FIXME: 增加location属性，方便翻译编辑
@@ -57,6 +57,7 @@
 #include <QList>
 #include <QHash>
 #include <QSet>
+#include <QVector>
 #include <QVariant>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -65,6 +66,19 @@
 #include "Object.h"
 #include "Parser.h"
 
+#if ENABLE_LOAD_PROFILING
+#include <QElapsedTimer>
+#endif
+#include <QJsonDocument>
+#include <QThreadPool>
+#include <QSharedPointer>
+
+class QFile;
+struct JsonPrefetchResult;
+struct JsonAsyncLoad;
+struct ConstructionTransaction;
+struct JsonTemplate;
+
 /**
  *  @class JsonLoader
  *  @brief JSON对象解析器（通常整个程序只需使用一个JsonLoader对象）
@@ -79,6 +93,11 @@ public:
      */
     JsonLoader();
 
+    /**
+     * Destructor
+     */
+    ~JsonLoader();
+
 public:
     /**
      *  @enum  ErrorCode
@@ -100,13 +119,17 @@ public:
         KeyParserError,                     //!< Key解析器错误
         StringValueParserError,             //!< StringValue解析器错误
         ArrayValueParserError,              //!< ArrayValue解析器错误
-        TranslationError                    //!< 翻译错误
+        TranslationError,                   //!< 翻译错误
+        InvalidTemplate                     //!< 无效的模板句柄
     };
 
     /**
      *  @enum  PropertyDependencyMode
      *  @brief 被加载的对象树的属性依赖关系
-     *  @note  目前不支持双向递归依赖，如果确实存在此问题，应在应用程序中尝试延迟初始化来解除递归依赖关系
+     *  @note  属性值中的名称引用（对象名、属性名及.ref）所构成的依赖关系总是被优先满足，
+     *         该模式决定父子对象之间的依赖方向，以及相互无依赖的对象之间的顺序
+     *  @note  目前不支持双向递归依赖，出现循环依赖时按该模式的顺序强制解除，
+     *         如果确实存在此问题，应在应用程序中尝试延迟初始化来解除递归依赖关系
      */
     enum PropertyDependencyMode
     {
@@ -116,6 +139,81 @@ public:
         Default = ParentDependsOnChildren   //!< 默认依赖
     };
 
+    /**
+     *  @enum  LoadPhase
+     *  @brief 载入过程的各个阶段，用于分阶段计时，各阶段的计时互不包含（嵌套阶段的耗时不计入外层阶段）
+     */
+    enum LoadPhase
+    {
+        OtherPhase = 0,                     //!< 不属于以下任何阶段的耗时，例如嵌套文件展开的调度
+        ReadJsonFilePhase,                  //!< readJsonFile：文件读取及缓冲区查找
+        RemoveCommentsPhase,                //!< removeComments：移除注释
+        ParseJsonPhase,                     //!< QJsonDocument::fromJson：JSON语法解析
+        CreateObjectContextTreePhase,       //!< createObjectContextTree：创建对象上下文树
+        CreateQObjectPhase,                 //!< createQObject：创建QObject对象
+        FindJsonObjectPhase,                //!< findJsonObject：查找嵌套的JSON文件
+        NestedFilePhase,                    //!< 嵌套JSON文件的展开（不含嵌套文件自身的读取、解析等阶段）
+        ParseKeysPhase,                     //!< parseKeys：解析属性、信号/槽等全部Key
+
+        LoadPhaseCount
+    };
+
+    /**
+     *  @enum  LoadCounter
+     *  @brief 载入过程的各项计数
+     */
+    enum LoadCounter
+    {
+        ContextCounter = 0,                 //!< 创建的对象上下文（ObjectContext）个数
+        QObjectCounter,                     //!< 创建或引用的QObject对象个数
+        PropertyCounter,                    //!< 成功写入的属性个数
+        NestedFileCounter,                  //!< 载入的嵌套JSON文件个数（包括.ref引用的文件）
+        BufferHitCounter,                   //!< JSON文件缓冲区的命中次数
+
+        LoadCounterCount
+    };
+
+    /**
+     *  @struct LoadStats
+     *  @brief  一次顶层载入操作的统计信息，时间单位均为纳秒
+     */
+    struct LoadStats
+    {
+        LoadStats() : totalTime(0)
+        {
+            for (int i = 0; i < LoadPhaseCount; i++)
+                phaseTime[i] = 0;
+            for (int i = 0; i < LoadCounterCount; i++)
+                counters[i] = 0;
+        }
+
+        qint64 totalTime;                   //!< 载入总耗时
+        qint64 phaseTime[LoadPhaseCount];   //!< 各载入阶段的耗时，各阶段之间互不包含
+        int    counters[LoadCounterCount];  //!< 各项计数
+    };
+
+    /**
+     *  @struct ErrorRecord
+     *  @brief  结构化的错误记录，错误消息仅在被使用时（发送error信号、生成报告等）才格式化
+     */
+    struct ErrorRecord
+    {
+        ErrorRecord(int code = NoError, const QString& message = QString(), ObjectContext* context = NULL)
+            : code(code), message(message), context(context), offset(-1)
+        {
+        }
+
+        int             code;               //!< 错误码
+        QString         message;            //!< 错误消息，指定了对象上下文时，其中的%1、%2、%3在格式化时依次替换为Key、Value及对象上下文的描述
+        ObjectContext*  context;            //!< 相关的对象上下文，仅在对象上下文被释放之前有效，可为NULL
+        QString         object;             //!< 对象上下文的描述，在对象上下文被释放之前生成
+        QString         key;                //!< 相关的Key，可为空
+        QString         value;              //!< 相关的Value，可为空
+        QString         file;               //!< 相关的JSON文件（或JSON数据的Key），可为空
+        int             offset;             //!< 错误在JSON数据中的偏移量，-1表示未知
+        QByteArray      jsonData;           //!< 发生解析错误的JSON数据，用于格式化时转储错误位置附近的代码
+    };
+
 public: 
     /*! 
      * 载入内存中的JSON数据（例如来自网络的、代码中的JSON）
@@ -135,6 +233,94 @@ public:
      */
     QVariant load(const QString& jsonFile, int defaultMetaType = QMetaType::UnknownType);
 
+    /*! 
+     * 载入已经解析的JSON文档
+     * @param[in]  document         JSON文档
+     * @param[in]  parentKey        通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
+     * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+     * @return     加载得到的根对象或根数组
+     */
+    QVariant load(const QJsonDocument& document, const QString& parentKey, int defaultMetaType = QMetaType::UnknownType);
+
+    /*! 
+     * 异步载入文件中的JSON数据：在工作线程中读取、移除注释并解析该文件及其嵌套的全部JSON文件，
+     * 完成后在本对象所在线程中创建对象，并发送loaded信号
+     * @param[in]  jsonFile         JSON文件路径
+     * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+     * @note       对象的创建及属性的赋值仍在本对象所在线程中进行，因此本函数必须在该线程中调用
+     */
+    void loadAsync(const QString& jsonFile, int defaultMetaType = QMetaType::UnknownType);
+
+    /*! 
+     * 重新载入已经载入的JSON文件，与保留的对象上下文树逐个对象（按Key）比较，仅应用发生变化的部分：
+     * 重新解析变化的Key、创建新增的对象、销毁被移除的对象，未变化的QObject对象保持不变
+     * @param[in]  jsonFile         JSON文件路径，必须与载入时使用的路径一致
+     * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+     * @return     重新载入后的根对象
+     * @note       对象的类型（.type/.ref/.copy）或id发生变化时，该对象及其子对象将被重新创建；
+     *             已经建立的信号/槽连接不会被断开；嵌套的JSON文件同样被重新读取并比较；
+     *             jsonFile为被嵌套的文件时，在其各个嵌套位置原地更新，并返回首个嵌套位置的根对象；
+     *             未载入过的文件等同于load
+     */
+    QVariant reload(const QString& jsonFile, int defaultMetaType = QMetaType::UnknownType);
+
+    /*! 
+     * 编译模板：读取、移除注释并解析一次JSON文件，此后通过instantiate反复创建该模板的实例而不必重新解析
+     * @param[in]  jsonFile         JSON文件路径，其根节点通常为一个对象（例如列表的一行、一张卡片）
+     * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（每个实例仅使用一次）
+     * @return     模板句柄，失败返回0
+     */
+    int compileTemplate(const QString& jsonFile, int defaultMetaType = QMetaType::UnknownType);
+
+    /*! 
+     * 创建模板的一个实例，每个实例拥有独立的名称作用域，实例内部的名称引用总是指向本实例中的对象
+     * @param[in]  templateHandle   compileTemplate返回的模板句柄
+     * @param[in]  parent           实例根对象的父对象，可为NULL
+     * @param[in]  overrides        覆盖模板根对象的Key，例如{"text": "Row 1", "icon.visible": false}
+     * @return     实例的根对象，失败返回NULL
+     * @note       实例可以通过unload卸载，使能了对象池的类型的对象将被下一个实例复用
+     */
+    QObject* instantiate(int templateHandle, QObject* parent = NULL, const QVariantMap& overrides = QVariantMap());
+
+    /*! 
+     * 释放模板，已经创建的实例不受影响
+     * @param[in]  templateHandle   模板句柄
+     */
+    void releaseTemplate(int templateHandle);
+
+    /*! 
+     * 设置快照缓存目录，使能后JSON文件解析得到的文档将以二进制形式保存于该目录，
+     * 此后源文件未改变（路径、大小、修改时间及内容摘要均相同）时直接映射快照，跳过JSON文本的解析
+     * @param[in]  cacheDir     快照缓存目录，为空时禁用快照缓存（默认）
+     * @return     操作成功返回true，未使能快照支持（见ENABLE_JSON_SNAPSHOT）时指定非空目录将返回false
+     * @note       校验内容摘要仍需读取源文件，但其开销远小于解析JSON文本
+     */
+    bool setSnapshotCacheDir(const QString& cacheDir);
+
+    /*! 
+     * 获取快照缓存目录
+     */
+    QString snapshotCacheDir() const
+    {
+        return m_snapshotCacheDir;
+    }
+
+    /*! 
+     * 设置是否使能嵌套JSON文件的预读，使能后发现嵌套的JSON文件时，立即在工作线程中读取、移除注释并解析该文件，
+     * GUI线程仅负责创建对象上下文及对象
+     * @param[in]  enabled  是否使能，默认不使能
+     * @note       使能快照缓存时不进行预读；预读结果仅在安排预读的顶层载入操作中使用，未被使用的结果在其结束时丢弃
+     */
+    void setPrefetchEnabled(bool enabled);
+
+    /*! 
+     * 是否使能嵌套JSON文件的预读
+     */
+    bool isPrefetchEnabled() const
+    {
+        return m_prefetchEnabled;
+    }
+
     /**
      * 添加一个全局对象，使该对象可以被本JsonLoader内部的各个QObject对象所引用，绑定信号/槽等
      * @param[in]    object 全局对象
@@ -154,6 +340,8 @@ public:
      * 根据对象名称从上到下查找已经加载的对象
      * @param[in]    objectName 对象名称
      * @return       查找结果，未找到则返回NULL
+     * @note         通过各作用域（根对象、嵌套文件、模板实例）的id索引查找，外层作用域优先；
+     *               对象位于尚未载入的延迟载入对象之下时，将先载入该延迟载入对象
      */
     QObject* findObject(const QString& objectName);
 
@@ -169,6 +357,49 @@ public:
         return qobject_cast<T>(object);
     }
 
+    /**
+     * 立即载入指定的延迟载入对象（JSON中指定了".lazy": true的对象）及其子对象树
+     * @param[in]    objectName 对象名称
+     * @return       载入得到的对象，未找到或创建失败则返回NULL
+     * @note         通过findObject或名称引用首次访问延迟载入对象时，也会自动载入；
+     *               objectName也可以是延迟载入对象的子对象，此时载入其所在的延迟载入对象并返回该子对象；
+     *               名称引用仅能找到延迟载入对象本身，其子对象仅在该对象载入后才能被引用；
+     *               延迟载入对象中嵌套的JSON文件在载入前不会被读取，其中的对象名称无法据此找到
+     */
+    QObject* materialize(const QString& objectName);
+
+    /**
+     * 卸载一个已经载入的对象（通常是某个界面的根对象）及其子对象树，并移除相应的对象上下文
+     * @param[in]    object 载入时创建的对象，通过.ref引用的对象不能卸载
+     * @return       未找到该对象的对象上下文时返回false
+     * @note         使能了对象池的类型（见setPoolCapacity）的对象被回收，下次载入时复用，其余对象被销毁
+     */
+    bool unload(QObject* object);
+
+    /*! 
+     * 设置指定类型的对象池容量，默认为0即不使用对象池，仅适用于QObject的子类
+     * @param[in]  objectType 类型id
+     * @param[in]  capacity   最多保留的空闲对象个数，为0时销毁池中的全部对象并禁用对象池
+     * @note       使能后载入时优先取出池中的对象，unload将对象恢复为初始属性值后放回池中；
+     *             对象池属于本对象，池中的空闲对象在本对象析构时销毁，因此含有控件的对象池应在QApplication之前析构
+     */
+    void setPoolCapacity(int objectType, int capacity)
+    {
+        m_objectPools.setCapacity(objectType, capacity);
+    }
+    int poolCapacity(int objectType) const
+    {
+        return m_objectPools.capacity(objectType);
+    }
+
+    /*! 
+     * 销毁全部对象池中的空闲对象，池的容量保持不变
+     */
+    void clearPools()
+    {
+        m_objectPools.clear();
+    }
+
     /*!  
      * Getter/Setter for defaultMetaType
      */
@@ -196,9 +427,128 @@ public:
     /*! 
      * 清除载入过程中使用的临时缓冲区等，释放内存
      * @note 执行本操作需要一定时间，仅用于内存资源受限的设备，并仅应在全部对象已经载入后使用一次
+     * @note 已经载入的对象上下文予以保留，findObject、translateAllStrings、reload等操作不受影响
      */
     void cleanup();
 
+    /*! 
+     * 释放全部已经载入的对象上下文（不销毁已经创建的QObject对象），全局对象将被保留，
+     * 用于在多次载入互不相关的JSON数据时，复用对象上下文的内存
+     * @note 此后findObject、translateAllStrings等操作仅对全局对象有效
+     */
+    void reset();
+
+    /*!
+     * Getter/Setter for errorRateLimit：每个错误码最多报告（发送信号或收集）的次数，超出后仅计数，0表示不限制（默认）
+     */
+    int errorRateLimit() const
+    {
+        return m_errorRateLimit;
+    }
+    void setErrorRateLimit(int errorRateLimit)
+    {
+        m_errorRateLimit = errorRateLimit;
+    }
+
+    /*!
+     * Getter/Setter for errorCollectionEnabled：使能后错误被收集到错误记录列表中，而不是逐条发送error信号
+     */
+    bool isErrorCollectionEnabled() const
+    {
+        return m_errorCollectionEnabled;
+    }
+    void setErrorCollectionEnabled(bool errorCollectionEnabled)
+    {
+        m_errorCollectionEnabled = errorCollectionEnabled;
+    }
+
+    /*!
+     * Getter/Setter for transactionalConstructionEnabled：事务式构建，默认禁用，
+     * 使能后load期间新建对象的信号被阻塞、布局被禁用、根控件暂停刷新、控件的显示被推迟，在load结束时一次性提交
+     */
+    bool isTransactionalConstructionEnabled() const
+    {
+        return m_transactionalConstructionEnabled;
+    }
+    void setTransactionalConstructionEnabled(bool transactionalConstructionEnabled)
+    {
+        m_transactionalConstructionEnabled = transactionalConstructionEnabled;
+    }
+
+    /*! 
+     * 获取自上次clearErrors以来指定错误码的发生次数（包括因超出限制而未报告的错误）
+     * @param[in]  code     错误码
+     * @return     发生次数
+     */
+    int errorCount(int code) const
+    {
+        return m_errorCounts.value(code);
+    }
+
+    /*! 
+     * 获取已经收集的错误记录，仅在使能错误收集时有效
+     */
+    const QList<ErrorRecord>& errorRecords() const
+    {
+        return m_errorRecords;
+    }
+
+    /*! 
+     * 格式化一条错误记录
+     * @param[in]  record   错误记录
+     * @return     错误消息
+     */
+    QString errorMessage(const ErrorRecord& record) const;
+
+    /*! 
+     * 生成错误报告，包括各错误码的发生次数及已经收集的全部错误消息
+     * @return     错误报告
+     */
+    QString errorReport() const;
+
+    /*! 
+     * 清除错误计数及已经收集的错误记录
+     */
+    void clearErrors();
+
+    /*!
+     * Getter for loadStatsEnabled，默认禁用，禁用时载入过程不进行任何计时和计数
+     */
+    bool isLoadStatsEnabled() const
+    {
+        return m_loadStatsEnabled;
+    }
+
+    /*! 
+     * 使能/禁用载入统计
+     * @param[in]  loadStatsEnabled 是否使能
+     * @return     操作成功返回true，未编译载入统计（见ENABLE_LOAD_PROFILING）时使能将报告UnsupportedFeature并返回false
+     */
+    bool setLoadStatsEnabled(bool loadStatsEnabled);
+
+    /*! 
+     * 获取最近一次顶层载入操作的统计信息
+     * @return     统计信息，未使能统计时全部为0
+     */
+    const LoadStats& loadStats() const
+    {
+        return m_loadStats;
+    }
+
+    /*! 
+     * 获取最近一次顶层载入操作中指定阶段的耗时
+     * @param[in]  phase    载入阶段
+     * @return     该阶段的累计耗时（纳秒）
+     */
+    qint64 loadPhaseTime(LoadPhase phase) const;
+
+    /*! 
+     * 获取载入阶段的名称，用于输出计时结果
+     * @param[in]  phase    载入阶段
+     * @return     阶段名称
+     */
+    static const char* loadPhaseName(LoadPhase phase);
+
     /**
      * 翻译/重新翻译全部的可翻译字符串（中文字符串或标记了`tr`的强制翻译的特殊字符串）
      * @return      成功翻译的字符串个数
@@ -221,6 +571,19 @@ public:
      */
     Q_SIGNAL void error(int code, const QString& message) const;
 
+    /*! 
+     * 异步载入完成信号
+     * @param[in]  jsonFile 载入的JSON文件路径
+     * @param[in]  result   加载得到的根对象或根数组，与load的返回值相同
+     */
+    Q_SIGNAL void loaded(const QString& jsonFile, const QVariant& result);
+
+    /*! 
+     * 载入完成信号，仅在使能统计时、每次顶层载入操作完成后发送
+     * @param[in]  stats    本次载入的统计信息
+     */
+    Q_SIGNAL void loadFinished(const JsonLoader::LoadStats& stats) const;
+
     /**
      * 注册一个外部的对象创建器，用于语法扩展
      * @param[in]    creator    对象创建器
@@ -284,6 +647,53 @@ protected:
         QList<ObjectContext*>& jsonObjectList
         );
 
+    /*! 
+     * 载入已经解析的JSON文档
+     * @param[in]  document             JSON文档
+     * @param[in]  parentContext        该JSON数据的父对象，该JSON中的全部对象将被挂载于父对象下方
+     * @param[in]  parentKey            通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
+     * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+     * @param[in]  jsonObjectList       可能是JSON文件的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+     * @return     加载得到的根对象或根数组
+     */
+    QVariant load(
+        const QJsonDocument& document,
+        ObjectContext& parentContext, 
+        const QString& parentKey,
+        QList<ObjectContext*>& possibleObjectList,
+        QList<ObjectContext*>& jsonObjectList
+        );
+
+    /*! 
+     * 载入已经解析的JSON文档，并完成嵌套JSON文件的载入及全部对象的属性解析
+     * @param[in]  document         JSON文档
+     * @param[in]  parentContext    该JSON数据的父对象，该JSON中的全部对象将被挂载于父对象下方
+     * @param[in]  parentKey        通常需要为该JSON数据指定一个Key，用于标识对象树的主分支
+     * @param[in]  defaultMetaType  如果JSON对象未指定类型，则使用此默认类型创建对象（仅使用一次）
+     * @return     加载得到的根对象或根数组
+     */
+    QVariant load(
+        const QJsonDocument& document,
+        ObjectContext& parentContext, 
+        const QString& parentKey,
+        int defaultMetaType
+        );
+
+    /*! 
+     * 解析（已经移除注释的）JSON数据，并报告解析错误
+     * @param[in]  jsonData     JSON数据
+     * @param[in]  parentKey    该JSON数据的Key，仅用于输出错误信息
+     * @return     解析得到的JSON文档，失败时返回空文档
+     */
+    QJsonDocument parseJsonDocument(const QByteArray& jsonData, const QString& parentKey);
+
+    /*! 
+     * 读取并解析一个JSON文件，使能快照缓存时优先使用快照
+     * @param[in]  jsonFile     JSON文件路径
+     * @return     解析得到的JSON文档，失败时返回空文档
+     */
+    QJsonDocument readJsonDocument(const QString& jsonFile);
+
     /*! 
      * 移除JSON数据中的注释（由于JSON原生语法不支持注释，这里人为引入C-Style注释并在解析前移除）
      * @param[in]  jsonData 含注释的JSON数据
@@ -291,6 +701,28 @@ protected:
      */
     QByteArray removeComments(const QByteArray& jsonData) const;
 
+public:
+    /*! 
+     * 移除JSON数据中的注释，不访问JsonLoader的任何状态，可在工作线程中调用
+     * @param[in]  jsonData 含注释的JSON数据
+     * @return     不含注释的JSON数据
+     */
+    static QByteArray stripComments(const QByteArray& jsonData);
+
+protected:
+    /*! 
+     * 在工作线程中预读并解析一个JSON文件，已经缓冲或正在预读的文件将被忽略
+     * @param[in]  jsonFile JSON文件路径
+     */
+    void prefetchJsonFile(const QString& jsonFile);
+
+    /*! 
+     * 等待并取走预读的JSON文档，错误信息在调用线程（GUI线程）中报告
+     * @param[in]  jsonFile JSON文件路径
+     * @return     解析得到的JSON文档，失败时返回空文档
+     */
+    QJsonDocument takePrefetchedDocument(const QString& jsonFile);
+
     /*! 
      * 根据指定的JSON数据及其子数据，创建（可能的）对象上下文（ObjectContext）树
      * @param[in]  jsonValue            定的JSON数据
@@ -303,9 +735,134 @@ protected:
         const QJsonValue& jsonValue, 
         ObjectContext& parentContext, 
         const QString& parentKey, 
-        QList<ObjectContext*>& possibleObjectList 
+        QList<ObjectContext*>& possibleObjectList,
+        bool lazyRootAllowed = false
+        );
+
+    /*! 
+     * 为对象上下文列表中新增的对象上下文创建QObject对象，并查找其中嵌套的JSON文件
+     * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表
+     * @param[in]  first                新增的第一个对象上下文在列表中的位置
+     * @param[in]  jsonObjectList       可能是JSON文件的对象上下文（ObjectContext）列表，追加模式，原内容不清空
+     */
+    void createQObjects(QList<ObjectContext*>& possibleObjectList, int first, QList<ObjectContext*>& jsonObjectList);
+
+    /*! 
+     * 依次载入对象上下文中嵌套的JSON文件，嵌套文件中再次嵌套的文件将被追加到队列中
+     * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表，追加模式
+     * @param[in]  jsonObjectList       可能是JSON文件的对象上下文（ObjectContext）列表，处理完毕后为空
+     */
+    void loadNestedJsonFiles(QList<ObjectContext*>& possibleObjectList, QList<ObjectContext*>& jsonObjectList);
+
+    /*! 
+     * 按照属性依赖关系的顺序，解析全部可能是对象的对象上下文的Key
+     * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表
+     */
+    void parseObjectListKeys(QList<ObjectContext*>& possibleObjectList);
+
+    /*! 
+     * 根据父子关系及名称引用建立对象上下文之间的依赖关系图，并按拓扑顺序排列，
+     * 相互无依赖的对象上下文保持propertyDependencyMode决定的顺序
+     * @param[in]  possibleObjectList   可能是对象的对象上下文（ObjectContext）列表
+     * @return     按依赖关系排序的对象上下文列表
+     */
+    QVector<ObjectContext*> sortByDependencies(const QList<ObjectContext*>& possibleObjectList) const;
+
+    /*! 
+     * 载入一个延迟载入的对象上下文：创建QObject对象、展开子对象上下文树并解析全部Key
+     * @param[in]  lazyContext  延迟载入的对象上下文
+     * @return     创建了QObject对象则返回true
+     */
+    bool materialize(LazyLoadObjectContext& lazyContext);
+
+    /*! 
+     * 在尚未载入的延迟载入对象的JSON中查找指定名称的子对象，找到后载入其所在的延迟载入对象
+     * @param[in]  objectName   对象名称
+     * @return     载入了某个延迟载入对象则返回true
+     */
+    bool materializeLazyOwner(const QString& objectName);
+
+    /*! 
+     * 登记延迟载入对象的JSON中全部对象的id，未找到的名称据此定位需要载入的延迟载入对象
+     * @param[in]  lazyContext  延迟载入的对象上下文
+     */
+    void registerLazyOwner(LazyLoadObjectContext* lazyContext);
+
+    /*! 
+     * 移除延迟载入对象登记的id，在其载入或释放时调用
+     * @param[in]  lazyContext  延迟载入的对象上下文
+     */
+    void unregisterLazyOwner(LazyLoadObjectContext* lazyContext);
+
+    /*! 
+     * 收集指定的对象上下文（包括其自身）之下的全部嵌套JSON文件的根对象上下文
+     * @param[in]  contexts     对象上下文列表
+     * @return     嵌套JSON文件的根对象上下文列表，外层的嵌套文件在前
+     */
+    ObjectContextList nestedJsonFileContexts(const ObjectContextList& contexts) const;
+
+    /*! 
+     * 重新载入时，重新读取并比较嵌套的JSON文件
+     * @param[in]  nestedContexts       嵌套JSON文件的根对象上下文列表，外层的嵌套文件在前，其缓冲区须已丢弃
+     * @param[in]  possibleObjectList   新创建的可能是对象的对象上下文列表，追加模式，原内容不清空
+     * @param[in]  changedKeys          需要重新解析的Key列表，追加模式，原内容不清空
+     */
+    void reloadNestedJsonFiles(
+        const ObjectContextList& nestedContexts,
+        QList<ObjectContext*>& possibleObjectList,
+        QList<QPair<ObjectContext*, QString> >& changedKeys
+        );
+
+    /*! 
+     * 重新载入时，比较并更新对象上下文的一个Key，无法复用原有对象时重建该Key下的全部对象上下文
+     * @param[in]  parentContext        对象上下文
+     * @param[in]  key                  JSON中的原始Key（可能含有tags）
+     * @param[in]  jsonValue            该Key新的JSON Value
+     * @param[in]  possibleObjectList   新创建的可能是对象的对象上下文列表，追加模式，原内容不清空
+     * @param[in]  changedKeys          需要重新解析的Key列表，追加模式，原内容不清空
+     */
+    void reloadKey(
+        ObjectContext& parentContext, 
+        const QString& key, 
+        const QJsonValue& jsonValue,
+        QList<ObjectContext*>& possibleObjectList,
+        QList<QPair<ObjectContext*, QString> >& changedKeys
         );
 
+    /*! 
+     * 重新载入时，比较并更新一个（可复用的）对象的全部Key
+     * @param[in]  objectContext        对象上下文
+     * @param[in]  jsonObject           该对象新的JSON对象
+     * @param[in]  possibleObjectList   新创建的可能是对象的对象上下文列表，追加模式，原内容不清空
+     * @param[in]  changedKeys          需要重新解析的Key列表，追加模式，原内容不清空
+     */
+    void reloadObject(
+        ObjectContext& objectContext, 
+        const QJsonObject& jsonObject,
+        QList<ObjectContext*>& possibleObjectList,
+        QList<QPair<ObjectContext*, QString> >& changedKeys
+        );
+
+    /*! 
+     * 移除并释放对象上下文的一个Key下的全部对象上下文，并销毁其中载入时创建的QObject对象
+     * @param[in]  parentContext    对象上下文
+     * @param[in]  key              Key（不含tags）
+     */
+    void unloadKey(ObjectContext& parentContext, const QString& key);
+
+    /*! 
+     * 释放已经从父对象上下文移除的对象上下文及其子对象上下文，并销毁（或回收至对象池）其中载入时创建的QObject对象
+     * @param[in]  contexts         对象上下文列表
+     */
+    void unloadObjectContexts(const ObjectContextList& contexts);
+
+    /*! 
+     * 若一个Key的值中含有尚未载入的延迟载入对象，则推迟该Key的解析，直到这些对象被载入
+     * @param[in]  iter     对象上下文的Key迭代器
+     * @return     需要推迟解析则返回true
+     */
+    bool deferLazyKey(KeyObjectContextMapConstIter iter);
+
     /*! 
      * 为指定的对象上下文创建QObject对象
      * @param[in]  objectContext 指定的对象上下文
@@ -337,12 +894,12 @@ protected:
     bool parseKeys(ObjectContext& objectContext);
 
     /*! 
-     * 解析Key或者Value中的tags
+     * 解析Key或者Value中的tags，不含反引号的字符串不产生任何拷贝
      * @param[inout] string JSON中的原始字符串，以及裁减后的字符串输出
-     * @param[in]    tags   解析得到的tags
-     * @return       解析得到的tag个数
+     * @param[in]    tags   解析得到的tags，追加模式，原内容不清空
+     * @return       解析得到的tag个数，失败返回-1
      */
-    int parseTags(QString& string, QStringList& tags) const;
+    int parseTags(QString& string, ValueTags& tags) const;
 
     /*! 
      * 解析指定的对象上下文的一个JSON Value
@@ -386,11 +943,12 @@ protected:
      * 读取一个JSON文件的全部数据，去除注释并缓存，从而加快多次载入的文件的处理速度
      * @param[in]  jsonFile JSON文件路径
      * @return     载入的JSON数据
+     * @note       不含注释的文件直接返回映射的数据而不缓存，调用者解析完毕后须调用unmapJsonFile
      */
     QByteArray readJsonFile(const QString& jsonFile);
 
     /*! 
-     * 分配一个对象上下文，可能使用内存池
+     * 分配一个对象上下文，使用内存池
      * @param[in]  parentKey    用于初始化该对象上下文的parentKey
      * @param[in]  jsonValue    用于初始化该对象上下文的jsonValue
      * @return     分配得到的对象上下文指针
@@ -398,12 +956,62 @@ protected:
     ObjectContext* allocObjectContext(const QString& parentKey, const QJsonValue& jsonValue);
 
     /*! 
-     * 释放一个对象上下文，可能使用内存池
+     * 释放一个对象上下文，归还至内存池
      * @param[in]  objectContext 分配得到的对象上下文指针
      * @return     操作成功返回true
      */
     bool freeObjectContext(ObjectContext* objectContext);
 
+    /*! 
+     * 分配一个延迟载入的对象上下文，不使用内存池
+     * @param[in]  parentKey    用于初始化该对象上下文的parentKey
+     * @param[in]  jsonValue    用于初始化该对象上下文的jsonValue，必须为JSON对象
+     * @return     分配得到的对象上下文指针
+     */
+    LazyLoadObjectContext* allocLazyObjectContext(const QString& parentKey, const QJsonValue& jsonValue);
+
+    /*! 
+     * 释放全部对象上下文，并重新添加全局对象，内存池的内存块保留用于下一次载入
+     */
+    void resetObjectContexts();
+
+    /*! 
+     * 关闭一个内存映射的JSON文件，readJsonFile返回的数据解析完毕后立即调用
+     * @param[in]  jsonFile     JSON文件路径
+     */
+    void unmapJsonFile(const QString& jsonFile);
+
+    /*! 
+     * 关闭全部内存映射的JSON文件及快照文件，调用前需要确保各缓冲区及对象上下文中不再引用映射的数据
+     */
+    void unmapJsonFiles();
+
+    /*! 
+     * 关闭已被替换的快照文件，调用前需要确保对象上下文中不再引用其中的数据
+     */
+    void unmapRetiredJsonFiles();
+
+    /*! 
+     * 将解析得到的JSON文档写入快照缓存目录
+     * @param[in]  jsonFile     JSON文件路径
+     * @param[in]  document     解析得到的JSON文档
+     * @return     操作成功返回true
+     */
+    bool writeSnapshot(const QString& jsonFile, const QJsonDocument& document) const;
+
+    /*! 
+     * 从快照缓存目录中读取JSON文件对应的快照，快照与源文件不一致时视为无效
+     * @param[in]  jsonFile     JSON文件路径
+     * @return     快照中的JSON文档，快照不存在或无效时返回空文档
+     */
+    QJsonDocument readSnapshot(const QString& jsonFile);
+
+    /*! 
+     * 异步载入的工作线程任务完成后，在本对象所在线程中完成载入
+     * @param[in]  requestId    异步载入请求的序号
+     */
+    Q_SLOT void finishAsyncLoad(int requestId);
+
 #if JSON_LOADER_DEBUGGING_LEVEL >= 1
     /*! 
      * JsonLoader错误的默认处理槽函数，输出错误打印信息，可通过宏配置禁用该功能
@@ -413,6 +1021,61 @@ protected:
     Q_SLOT void reportError(int code, const QString& message) const;
 #endif
 
+    /*! 
+     * 报告一个错误：计数，并根据配置收集该错误记录或发送error信号，未超出限制且有人接收时才格式化错误消息
+     * @param[in]  record   错误记录
+     */
+    void raiseError(const ErrorRecord& record) const;
+
+    /*! 
+     * 报告一个错误
+     * @param[in]  code     错误码
+     * @param[in]  message  错误消息，指定了对象上下文时，其中的%1、%2、%3将依次被替换为Key、Value及对象上下文的描述
+     * @param[in]  context  相关的对象上下文
+     * @param[in]  key      相关的Key
+     * @param[in]  value    相关的Value
+     */
+    void raiseError(
+        int code, const QString& message, ObjectContext* context = NULL, 
+        const QString& key = QString(), const QString& value = QString()
+        ) const
+    {
+        ErrorRecord record(code, message, context);
+        record.key   = key;
+        record.value = value;
+        raiseError(record);
+    }
+
+    /*! 
+     * 在对象上下文被释放之前，格式化已经收集的错误记录中引用了对象上下文的部分
+     */
+    void resolveErrorRecords();
+
+    /*! 
+     * 事务式构建期间，登记一个新建的对象：阻塞其信号，禁用其布局（如果是QLayout）
+     * @param[in]  qObject  新建的对象
+     */
+    void addConstructedObject(QObject* qObject);
+
+    /*! 
+     * 事务式构建期间，新建对象的全部对象创建完毕后，暂停其中根控件的刷新
+     */
+    void suspendConstructedWidgetUpdates();
+
+    /*! 
+     * 事务式构建期间，判断是否推迟一个属性的写入，目前仅推迟新建控件的显示（visible为true）
+     * @param[in]  qObject  对象
+     * @param[in]  property 属性
+     * @param[in]  value    属性值
+     * @return     推迟写入返回true
+     */
+    bool deferPropertyWrite(QObject* qObject, const QMetaProperty& property, const QVariant& value);
+
+    /*! 
+     * 提交事务式构建：恢复信号、启用布局、显示控件，最后恢复根控件的刷新
+     */
+    void commitConstruction();
+
     /*! 
      * 转储JSON数据，用于在Qt的JSON解析库报错时，显示错误位置对应的代码
      * @param[in]  data     完整的JSON数据，建议以换行作为格式化方法
@@ -421,30 +1084,114 @@ protected:
      */
     QString dumpJsonData(const QByteArray& data, int offset) const;
 
+    /*! 
+     * 开始/结束一次顶层载入操作，嵌套的载入操作不会重复调用
+     */
+    void beginLoad();
+    void endLoad();
+
+#if ENABLE_LOAD_PROFILING
+    /*! 
+     * 开始/结束一次顶层载入操作的分阶段计时，嵌套的载入操作不会重新计时
+     */
+    void beginLoadProfiling();
+    void endLoadProfiling();
+
+    /*! 
+     * 切换当前的载入阶段，并将已经经过的时间计入之前的阶段
+     * @param[in]  phase    新的载入阶段
+     * @return     之前的载入阶段
+     */
+    LoadPhase switchLoadPhase(LoadPhase phase);
+
+    /*! 
+     * 累加一项载入计数，仅在使能统计且处于载入过程中时有效
+     * @param[in]  counter  计数项
+     */
+    void addLoadStatsCount(LoadCounter counter)
+    {
+        if (m_loadStatsEnabled && m_loadDepth > 0) {
+            ++m_loadStats.counters[counter];
+        }
+    }
+#endif
 
 private:
     ObjectContext                   m_rootObjectContext;                //!< 根对象上下文
     QSet<ObjectContext*>            m_translations;                     //!< 可翻译字符串列表
+    QHash<ObjectContext*, QString>  m_nestedJsonFiles;                  //!< 嵌套JSON文件的根对象上下文到文件路径的映射，用于重新载入
 
     QList<ObjectCreator*>           m_objectCreators;                   //!< 对象创建器容器
     QList<KeyParser*>               m_keyParsers;                       //!< Key解析器容器
+    QHash<QString, QList<KeyParser*> > m_keyParserTable;                //!< Key到匹配的Key解析器列表的分派表
     QHash<int, ArrayValueParser*>   m_arrayValueParsers;                //!< ArrayValue解析器容器
+    QHash<int, int>                 m_arrayElementTypes;                //!< 容器类型到元素类型的映射，注册解析器时建立
+    QHash<QString, int>             m_arrayElementTypeNames;            //!< 容器类型名称到元素类型的映射，注册解析器时建立
     QHash<int, StringValueParser*>  m_stringValueParsers;               //!< StringValue解析器容器
 
     QHash<QString, QByteArray>      m_jsonDataBuffer;                   //!< 已载入的JSON文件内容的缓冲区
-#if ENABLE_MEM_POOL
-    QList<ObjectContext>            m_objectContextBuffer;              //!< 用于分配对象上下文的内存池
-#endif
+    QHash<QString, QJsonDocument>   m_jsonDocumentBuffer;               //!< 使能快照缓存时，已载入的JSON文档的缓冲区
+    QHash<QString, QFile*>          m_mappedJsonFiles;                  //!< 正在解析的JSON文件及快照文件的内存映射
+    QList<QFile*>                   m_retiredMappedFiles;               //!< 已被替换但可能仍被对象上下文引用的快照文件，对象上下文释放后关闭
+    QString                         m_snapshotCacheDir;                 //!< 快照缓存目录，为空时不使用快照缓存
+    bool                            m_prefetchEnabled;                  //!< 是否使能嵌套JSON文件的预读
+    QThreadPool                     m_prefetchPool;                     //!< 预读任务的线程池
+    QHash<QString, QSharedPointer<JsonPrefetchResult> > m_prefetchResults; //!< 当前顶层载入操作中正在预读或尚未取走的结果
+    QHash<int, QSharedPointer<JsonAsyncLoad> > m_asyncLoads;            //!< 正在进行的异步载入请求
+    int                             m_asyncLoadId;                      //!< 下一个异步载入请求的序号
+    QHash<int, QSharedPointer<JsonTemplate> > m_templates;              //!< 已经编译的模板
+    int                             m_templateId;                       //!< 下一个模板的句柄
+    QSet<ObjectContext*>            m_templateScopes;                   //!< 模板实例的作用域对象上下文
+    ObjectContextPool               m_objectContextPool;                //!< 用于分配对象上下文的内存池
+    ObjectPoolTable                 m_objectPools;                      //!< 各类型的QObject对象池
+    QHash<QObject*, ObjectContext*> m_createdObjectContexts;            //!< 载入时创建的对象到其对象上下文的映射，用于卸载
+    QList<LazyLoadObjectContext*>   m_lazyObjectContexts;               //!< 全部延迟载入的对象上下文，由本对象释放
+    QMultiHash<QString, LazyLoadObjectContext*> m_lazyOwners;           //!< 尚未载入的延迟载入对象的JSON中的id到该延迟载入对象的映射
+
+    int                             m_errorRateLimit;                   //!< 每个错误码最多报告的次数，0表示不限制
+    bool                            m_errorCollectionEnabled;           //!< 是否收集错误记录而不是逐条发送信号
+    mutable QHash<int, int>         m_errorCounts;                      //!< 各错误码的发生次数
+    mutable QList<ErrorRecord>      m_errorRecords;                     //!< 已经收集的错误记录
+    mutable int                     m_unresolvedErrorCount;             //!< 已经收集的错误记录中仍引用对象上下文的个数
+
+    bool                            m_transactionalConstructionEnabled; //!< 是否使能事务式构建
+    ConstructionTransaction*        m_constructionTransaction;          //!< 当前的构建事务，仅在最外层load期间有效
 
     int                             m_defaultMetaType;                  //!< 载入顶层JSON数据时，提供的默认MetaType提示
     PropertyDependencyMode          m_propertyDependencyMode;           //!< 对象树的属性依赖关系
 
+    bool                            m_loadStatsEnabled;                 //!< 是否使能载入统计
+    LoadStats                       m_loadStats;                        //!< 最近一次顶层载入操作的统计信息
+    int                             m_loadDepth;                        //!< 载入操作的嵌套深度，仅在最外层开始/结束顶层载入操作
+
+    /*
+     * @brief 载入范围辅助类需要通知顶层载入操作的开始/结束
+     */
+    friend struct LoadScope;
+#if ENABLE_LOAD_PROFILING
+    LoadPhase                       m_currentLoadPhase;                 //!< 当前所处的载入阶段
+    qint64                          m_loadPhaseStart;                   //!< 当前载入阶段的开始时间
+    QElapsedTimer                   m_loadPhaseClock;                   //!< 载入计时器
+
+    /*
+     * @brief 计时辅助类需要访问阶段切换操作
+     */
+    friend struct LoadPhaseTimer;
+#endif
+
     /*
      * @brief 由于IParser中使用了JsonLoader的保护操作，这里声明为友元
      */
     friend class IParser;
+
+    /*
+     * @brief 延迟载入的对象上下文在首次访问时需要调用JsonLoader的载入操作
+     */
+    friend class LazyLoadObjectContext;
 };
 
+Q_DECLARE_METATYPE(JsonLoader::LoadStats)
+
 #endif
 /*********************************************************************************************************
 ** End of file
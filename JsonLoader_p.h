@@ -35,10 +35,39 @@
  */
 #define ENABLE_TS_FILE                      1
 /**
- *  @macro ENABLE_MEM_POOL
- *  @brief 是否使能内存池，在某些平台下使能内存池可以提高解析器的运行效率
+ *  @macro ENABLE_FILE_MAPPING
+ *  @brief 是否使用内存映射的方式读取JSON文件，仅在需要移除注释时拷贝文件数据，从而降低载入时的内存峰值
  */
-#define ENABLE_MEM_POOL                     0
+#ifndef ENABLE_FILE_MAPPING
+#define ENABLE_FILE_MAPPING                 1
+#endif
+/**
+ *  @macro ENABLE_JSON_SNAPSHOT
+ *  @brief 是否支持JSON文档的快照缓存，快照使用QJsonDocument的二进制格式，
+ *         该格式自Qt 5.15起被废弃并在Qt 6中移除，因此默认仅在较低版本的Qt中使能
+ */
+#ifndef ENABLE_JSON_SNAPSHOT
+#include <QtGlobal>
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+#define ENABLE_JSON_SNAPSHOT                1
+#else
+#define ENABLE_JSON_SNAPSHOT                0
+#endif
+#endif
+/**
+ *  @macro ENABLE_LOAD_PROFILING
+ *  @brief 是否编译载入过程的分阶段计时及计数，用于定位大型界面的载入耗时，
+ *         运行时仍需通过JsonLoader::setLoadStatsEnabled开启，未开启时每个计时点仅需一次判断；
+ *         设置为0时不产生任何额外代码，此时无法开启载入统计
+ */
+#ifndef ENABLE_LOAD_PROFILING
+#define ENABLE_LOAD_PROFILING               1
+#endif
+#if ENABLE_LOAD_PROFILING
+#define LOAD_STATS_COUNT(_counter)          addLoadStatsCount(JsonLoader::_counter)
+#else
+#define LOAD_STATS_COUNT(_counter)
+#endif
 /**
  *  @macro ENABLE_LEGACY_KEYWORDS
  *  @brief 是否使能旧版本的关键字（例如metaType在新版本中已经调整为.type），如果不需要兼容旧的json文件请关闭以提高效率
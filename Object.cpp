@@ -32,14 +32,48 @@
 #include <QMetaProperty>
 #include <QtWidgets/QWidget>
 
+#include <new>
+#include <string.h>
+
 /**
  * Constructor
  */
-Object::Object() : m_qobject(NULL), m_parent(NULL)
+Object::Object() : m_qobject(NULL), m_parent(NULL), m_nameIdChildCount(0), m_idScope(NULL)
 {
     // TODO: Not yet implemented
 }
 
+Object::Object( const Object& other ) : 
+    m_qobject(other.m_qobject), 
+    m_parent(other.m_parent), 
+    m_id(other.m_id), 
+    m_children(other.m_children), 
+    m_childIdIndex(other.m_childIdIndex), 
+    m_nameIdChildCount(other.m_nameIdChildCount), 
+    m_idScope(NULL)
+{
+
+}
+
+Object& Object::operator=( const Object& other )
+{
+    if (this != &other)
+    {
+        m_qobject = other.m_qobject;
+        m_parent = other.m_parent;
+        m_id = other.m_id;
+        m_children = other.m_children;
+        m_childIdIndex = other.m_childIdIndex;
+        m_nameIdChildCount = other.m_nameIdChildCount;
+    }
+    return *this;
+}
+
+Object::~Object()
+{
+    delete m_idScope;
+}
+
 /**
  * 向上查找指定的对象
  * @param[in]    objectName 对象名称
@@ -47,29 +81,18 @@ Object::Object() : m_qobject(NULL), m_parent(NULL)
  */
 Object* Object::findUpwards( const QString& objectName ) const
 {
-    QQueue<Object*> objectQ;
-
     if (m_id == objectName) {
         return const_cast<Object*>(this);
     }
 
-    if (m_parent) {
-        objectQ.enqueue(const_cast<Object*>(m_parent));
-    }
-
+    // 逐层查找各级父对象的子对象，每层仅需一次id索引查找
     const Object* object = this;
     while (object = object->m_parent)
     {
-        QList<Object*>::const_iterator iter = object->m_children.cbegin();
-        QList<Object*>::const_iterator cend = object->m_children.cend();
-        for (iter; iter != cend; ++iter)
+        Object* child = object->childById(objectName);
+        if (child)
         {
-            Object* child = (*iter);
-            //QString id = object->id();
-            if (child && child->id() == objectName)
-            {
-                return child;
-            }
+            return child;
         }
     }
 
@@ -96,7 +119,13 @@ Object* Object::findDownwards(const QString& objectName) const
         if (object->id() == objectName)
             return object;
 
-        objectQ.append(object->children());
+        // 直接遍历子对象列表，避免拷贝
+        QList<Object*>::const_iterator iter = object->m_children.cbegin();
+        QList<Object*>::const_iterator cend = object->m_children.cend();
+        for (; iter != cend; ++iter)
+        {
+            objectQ.enqueue(*iter);
+        }
     }
 
     return NULL;
@@ -114,8 +143,22 @@ bool Object::addChild( Object* object )
 
     object->m_parent = this;
     m_children.push_back(object);
+    if (object->m_id.isEmpty()) {
+        m_nameIdChildCount++;
+    }
 
-    return object->setParent(this);
+    QString id = object->id();
+    if (!id.isEmpty() && !m_childIdIndex.contains(id)) {
+        m_childIdIndex.insert(id, object);
+    }
+
+    bool ok = object->setParent(this);
+
+    Object* scopeRoot = childIdScope();
+    if (scopeRoot) {
+        scopeRoot->registerIds(object);
+    }
+    return ok;
 }
 
 /**
@@ -130,9 +173,295 @@ bool Object::removeChild( Object* object )
 
     object->m_parent = NULL;
     int count = m_children.removeAll(object);
+    if (count > 0) 
+    {
+        Object* scopeRoot = childIdScope();
+        if (scopeRoot) {
+            scopeRoot->unregisterIds(object);
+        }
+
+        removeChildIdIndex(object, object->id());
+        if (object->m_id.isEmpty()) {
+            m_nameIdChildCount -= count;
+        }
+    }
     return count > 0;
 }
 
+/**
+ * 根据id查找直接子对象（使用子对象的id索引），存在多个同名子对象时返回最先添加的子对象
+ * @param[in]    objectName 对象名称
+ * @return       查找到的对象指针，未找到则返回NULL
+ */
+Object* Object::childById( const QString& objectName ) const
+{
+    QHash<QString, Object*>::iterator iter = m_childIdIndex.find(objectName);
+    bool stale = false;
+    if (iter != m_childIdIndex.end())
+    {
+        if (iter.value()->id() == objectName)
+            return iter.value();
+
+        // 索引的子对象已被改名（objectName被修改）
+        m_childIdIndex.erase(iter);
+        stale = true;
+    }
+
+    // 显式指定的id总是被索引，只有id来自objectName的子对象可能在索引之外，
+    // 例如JSON中的objectName属性或代码在对象加入后才设置了objectName
+    if (!stale && m_nameIdChildCount == 0)
+        return NULL;
+
+    QList<Object*>::const_iterator childIter = m_children.cbegin();
+    QList<Object*>::const_iterator childEnd = m_children.cend();
+    for (; childIter != childEnd; ++childIter)
+    {
+        Object* child = *childIter;
+        if (child && child->id() == objectName) 
+        {
+            m_childIdIndex.insert(objectName, child);
+            return child;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * 更新子对象的id索引，在子对象的id改变时调用
+ * @param[in]    child  子对象
+ * @param[in]    oldId  子对象原来的id
+ */
+void Object::updateChildIdIndex( Object* child, const QString& oldId )
+{
+    QString id = child->id();
+    if (id == oldId)
+        return;
+
+    removeChildIdIndex(child, oldId);
+    if (!id.isEmpty() && !m_childIdIndex.contains(id)) {
+        m_childIdIndex.insert(id, child);
+    }
+}
+
+/**
+ * 从id索引中移除一个子对象，若存在其他同名子对象则使用其替代
+ * @param[in]    child  子对象
+ * @param[in]    id     子对象的id
+ */
+void Object::removeChildIdIndex( Object* child, const QString& id )
+{
+    if (id.isEmpty())
+        return;
+
+    QHash<QString, Object*>::iterator iter = m_childIdIndex.find(id);
+    if (iter == m_childIdIndex.end() || iter.value() != child)
+        return;
+
+    // 同名子对象极少出现，仅在此时线性查找替代者
+    m_childIdIndex.erase(iter);
+    foreach (Object* other, m_children)
+    {
+        if (other && other != child && other->id() == id) 
+        {
+            m_childIdIndex.insert(id, other);
+            break;
+        }
+    }
+}
+
+/**
+ * 将本对象设置为id作用域的根对象，其下对象的id改为登记在本对象的作用域索引中，
+ * 本对象自身的id仍登记在外层作用域中
+ */
+void Object::setIdScope()
+{
+    if (m_idScope)
+        return;
+
+    // 子对象树原先登记在外层作用域中，移入本作用域后外层仅保留本对象
+    Object* outerScope = m_parent ? m_parent->childIdScope() : NULL;
+    if (outerScope) {
+        outerScope->unregisterIds(this);
+    }
+
+    m_idScope = new ObjectIdScope;
+    if (outerScope) {
+        outerScope->registerIds(this);
+    }
+
+    foreach (Object* child, m_children) {
+        registerIds(child);
+    }
+}
+
+/**
+ * 在本对象的id作用域及其嵌套的作用域中查找指定的对象，外层作用域优先，
+ * 同一作用域中存在多个同名对象时返回层级最浅者
+ * @param[in]    objectName 对象名称
+ * @return       查找到的对象指针，未找到则返回NULL
+ */
+Object* Object::findInIdScope( const QString& objectName ) const
+{
+    if (!m_idScope)
+        return findDownwards(objectName);
+
+    QQueue<const Object*> scopeQ;
+    scopeQ.enqueue(this);
+
+    while (!scopeQ.isEmpty())
+    {
+        const Object* scopeRoot = scopeQ.dequeue();
+        QMultiHash<QString, Object*>& ids = scopeRoot->m_idScope->ids;
+
+        Object* found = NULL;
+        int foundDepth = 0;
+        QList<Object*> renamedObjects;
+        QMultiHash<QString, Object*>::iterator iter = ids.find(objectName);
+        while (iter != ids.end() && iter.key() == objectName)
+        {
+            Object* object = iter.value();
+            if (object->id() != objectName)
+            {
+                // objectName在载入器之外被修改，稍后按新的id重新登记
+                renamedObjects.push_back(object);
+                iter = ids.erase(iter);
+                continue;
+            }
+
+            int depth = 0;
+            for (const Object* ancestor = object->m_parent; ancestor && ancestor != scopeRoot; ancestor = ancestor->m_parent) {
+                depth++;
+            }
+            // 同名对象按登记的逆序排列，层级相同时取最先登记者
+            if (!found || depth <= foundDepth) 
+            {
+                found = object;
+                foundDepth = depth;
+            }
+            ++iter;
+        }
+
+        foreach (Object* object, renamedObjects)
+        {
+            object->m_scopedId = object->id();
+            if (!object->m_scopedId.isEmpty()) {
+                ids.insert(object->m_scopedId, object);
+            }
+        }
+
+        if (found)
+            return found;
+
+        foreach (const Object* childScope, scopeRoot->m_idScope->childScopes) {
+            scopeQ.enqueue(childScope);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * 对象的id（来自objectName）在载入器之外被修改后调用，同步父对象及所在作用域的id索引
+ * @param[in]    oldId  对象原来的id
+ */
+void Object::updateId( const QString& oldId )
+{
+    if (!m_parent)
+        return;
+
+    m_parent->updateChildIdIndex(this, oldId);
+
+    Object* scopeRoot = m_parent->childIdScope();
+    QString id = this->id();
+    if (!scopeRoot || id == m_scopedId)
+        return;
+
+    if (!m_scopedId.isEmpty()) {
+        scopeRoot->m_idScope->ids.remove(m_scopedId, this);
+    }
+    m_scopedId = id;
+    if (!id.isEmpty()) {
+        scopeRoot->m_idScope->ids.insert(id, this);
+    }
+}
+
+/**
+ * 获取本对象的子对象所在的id作用域的根对象，即最近的作为作用域根对象的本对象或祖先对象
+ */
+Object* Object::childIdScope() const
+{
+    const Object* object = this;
+    while (object && !object->m_idScope) {
+        object = object->m_parent;
+    }
+    return const_cast<Object*>(object);
+}
+
+/**
+ * 将一个对象及其子对象树登记到本对象的作用域索引中，遇到嵌套作用域时仅登记其根对象
+ */
+void Object::registerIds( Object* object )
+{
+    QQueue<Object*> objectQ;
+    objectQ.enqueue(object);
+
+    while (!objectQ.isEmpty())
+    {
+        Object* current = objectQ.dequeue();
+        if (!current)
+            continue;
+
+        // 记录登记时的id，移除时据此查找，不受其后objectName修改的影响
+        current->m_scopedId = current->id();
+        if (!current->m_scopedId.isEmpty()) {
+            m_idScope->ids.insert(current->m_scopedId, current);
+        }
+
+        if (current->m_idScope)
+        {
+            m_idScope->childScopes.push_back(current);
+            continue;
+        }
+
+        foreach (Object* child, current->m_children) {
+            objectQ.enqueue(child);
+        }
+    }
+}
+
+/**
+ * 从本对象的作用域索引中移除一个对象及其子对象树
+ */
+void Object::unregisterIds( Object* object )
+{
+    QQueue<Object*> objectQ;
+    objectQ.enqueue(object);
+
+    while (!objectQ.isEmpty())
+    {
+        Object* current = objectQ.dequeue();
+        if (!current)
+            continue;
+
+        if (!current->m_scopedId.isEmpty()) 
+        {
+            m_idScope->ids.remove(current->m_scopedId, current);
+            current->m_scopedId.clear();
+        }
+
+        if (current->m_idScope)
+        {
+            m_idScope->childScopes.removeOne(current);
+            continue;
+        }
+
+        foreach (Object* child, current->m_children) {
+            objectQ.enqueue(child);
+        }
+    }
+}
+
 /**
  * 获取指定位置的子对象
  * @param[in]    index 子对象序号
@@ -149,7 +478,12 @@ Object* Object::childAt(int index)
  */
 void Object::setQObject(QObject* qobject)
 {
+    // 未指定id时，对象的id来自QObject的objectName，需要同步父对象的id索引
+    QString oldId = m_parent && m_id.isEmpty() ? id() : QString();
     this->m_qobject = qobject;
+    if (m_parent && m_id.isEmpty()) {
+        updateId(oldId);
+    }
 }
 
 /**
@@ -167,7 +501,16 @@ QObject* Object::qObject() const
  */
 bool Object::setId(QString id)
 {
+    QString oldId = m_parent ? this->id() : QString();
+    bool wasNameId = this->m_id.isEmpty();
     this->m_id = id;
+    if (m_parent) 
+    {
+        if (wasNameId != id.isEmpty()) {
+            m_parent->m_nameIdChildCount += wasNameId ? -1 : 1;
+        }
+        updateId(oldId);
+    }
 
     if (m_qobject)
     {
@@ -259,32 +602,74 @@ ObjectContext::ObjectContext( const QString& parentKey, const QJsonValue& jsonVa
 
 }
 
-KeyObjectContextMapIter ObjectContext::child( const QString& key )
+int KeyObjectContextMap::indexOf( const QString& key ) const
 {
-    KeyObjectContextMapIter iter = m_keyObjectContextMap.begin();
-    KeyObjectContextMapIter cend  = m_keyObjectContextMap.end();
-    for (; iter != cend; ++iter)
+    int count = size();
+    if (count < IndexThreshold)
     {
-        if (iter->first == key) {
-            return iter;
+        // Key较少时，顺序查找比计算hash更快，也不需要维护索引
+        for (int i = 0; i < count; i++)
+        {
+            if (at(i).first == key) {
+                return i;
+            }
         }
+
+        return -1;
     }
 
-    return cend;
+    if (m_indexDirty)
+    {
+        m_index.clear();
+        m_index.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+            const QString& currentKey = at(i).first;
+            if (!m_index.contains(currentKey)) {
+                m_index.insert(currentKey, i);
+            }
+        }
+        m_indexDirty = false;
+    }
+
+    return m_index.value(key, -1);
 }
 
-KeyObjectContextMapConstIter ObjectContext::constChild( const QString& key )
+KeyObjectContextMap::iterator KeyObjectContextMap::erase( iterator iter )
 {
-    KeyObjectContextMapConstIter iter = m_keyObjectContextMap.cbegin();
-    KeyObjectContextMapConstIter cend  = m_keyObjectContextMap.cend();
-    for (; iter != cend; ++iter)
+    if (!m_indexDirty)
     {
-        if (iter->first == key) {
-            return iter;
+        int index = iter - begin();
+        int count = size();
+        QHash<QString, int>::iterator indexIter = m_index.find(iter->first);
+        if (indexIter != m_index.end() && indexIter.value() == index) {
+            m_index.erase(indexIter);
+        }
+
+        // 其后的元素前移一位，被删除的Key如果再次出现，则成为其首次出现的位置
+        for (int i = index + 1; i < count; i++)
+        {
+            const QString& currentKey = at(i).first;
+            indexIter = m_index.find(currentKey);
+            if (indexIter == m_index.end()) {
+                m_index.insert(currentKey, i - 1);
+            } else if (indexIter.value() == i) {
+                indexIter.value() = i - 1;
+            }
         }
     }
 
-    return cend;
+    return QList<KeyObjectContextPair>::erase(iter);
+}
+
+KeyObjectContextMapIter ObjectContext::child( const QString& key )
+{
+    return m_keyObjectContextMap.find(key);
+}
+
+KeyObjectContextMapConstIter ObjectContext::constChild( const QString& key )
+{
+    return m_keyObjectContextMap.constFind(key);
 }
 
 KeyObjectContextMapIter ObjectContext::addChild( const QString& key, ObjectContext* child, KeyObjectContextMapIter iter )
@@ -347,6 +732,48 @@ bool ObjectContext::removeChild( const QString& key, ObjectContext* child )
     return count > 0;
 }
 
+void ObjectContext::releaseConnections()
+{
+    foreach (const QMetaObject::Connection& connection, m_connections) {
+        QObject::disconnect(connection);
+    }
+    m_connections.clear();
+}
+
+void ObjectContext::clearChildren()
+{
+    KeyObjectContextMapConstIter iter = m_keyObjectContextMap.cbegin();
+    KeyObjectContextMapConstIter cend = m_keyObjectContextMap.cend();
+    for (; iter != cend; ++iter)
+    {
+        foreach (ObjectContext* child, iter->second)
+        {
+            if (child) {
+                child->m_parent = NULL;
+                child->Object::m_parent = NULL;
+            }
+        }
+    }
+
+    // 作用域根对象直接清空其索引，否则从所在作用域中逐个移除子对象树
+    if (m_idScope) 
+    {
+        m_idScope->ids.clear();
+        m_idScope->childScopes.clear();
+    }
+    else if (Object* scopeRoot = childIdScope())
+    {
+        foreach (Object* child, m_children) {
+            scopeRoot->unregisterIds(child);
+        }
+    }
+
+    m_keyObjectContextMap.clear();
+    m_children.clear();
+    m_childIdIndex.clear();
+    m_nameIdChildCount = 0;
+}
+
 QString ObjectContext::toString() const
 {
     QString value;
@@ -470,13 +897,40 @@ int ObjectContext::parentPropertyType() const
     return QMetaType::UnknownType;
 }
 
+namespace {
+
+/**
+ *  @struct MetaPropertyCache
+ *  @brief 单个元对象的属性解析结果缓存，同一类型的多个实例只需解析一次
+ */
+struct MetaPropertyCache
+{
+    QHash<QString, int> indices;            //!< 属性名称到属性序号的映射，-1表示不存在该属性
+    QHash<int, int>     metaTypes;          //!< 属性序号到属性metaType的映射，仅缓存已知类型
+};
+
+typedef QHash<const QMetaObject*, MetaPropertyCache> MetaPropertyCacheHash;
+
+// 对象的创建及属性的解析均在GUI线程中执行，因此不需要加锁
+Q_GLOBAL_STATIC(MetaPropertyCacheHash, metaPropertyCaches)
+
+}
+
 QMetaProperty ObjectContext::property( const QString& key ) const
 {
     if (m_qobject)
     {
         const QMetaObject* metaObject = m_qobject->metaObject();
         Q_ASSERT(metaObject);
-        int propertyIndex = metaObject->indexOfProperty(key.toLatin1().constData());
+        QHash<QString, int>& indices = (*metaPropertyCaches())[metaObject].indices;
+        QHash<QString, int>::const_iterator iter = indices.constFind(key);
+        int propertyIndex = -1;
+        if (iter != indices.constEnd()) {
+            propertyIndex = iter.value();
+        } else {
+            propertyIndex = metaObject->indexOfProperty(key.toLatin1().constData());
+            indices.insert(key, propertyIndex);
+        }
         if (propertyIndex >= 0) {
             return metaObject->property(propertyIndex);
         }
@@ -500,6 +954,13 @@ int ObjectContext::propertyType( const QMetaProperty& property) const
         return propertyTypeId;
     }
 
+    // 以声明该属性的元对象及属性序号作为缓存的key
+    QHash<int, int>& metaTypes = (*metaPropertyCaches())[property.enclosingMetaObject()].metaTypes;
+    QHash<int, int>::const_iterator iter = metaTypes.constFind(property.propertyIndex());
+    if (iter != metaTypes.constEnd()) {
+        return iter.value();
+    }
+
     const char* propertyTypeStr = property.typeName();
     QString propertyTypeName = QString::fromLatin1(propertyTypeStr);
 
@@ -516,47 +977,210 @@ int ObjectContext::propertyType( const QMetaProperty& property) const
     }
 
     int metaTypeId = GET_METATYPE_ID_METHOD(propertyTypeName);
+    // 类型可能稍后才被注册，因此不缓存未知类型
+    if (metaTypeId != QMetaType::UnknownType) {
+        metaTypes.insert(property.propertyIndex(), metaTypeId);
+    }
     return metaTypeId;
 }
 
 QList<QMetaMethod> ObjectContext::methods( const QString& key ) const
 {
-    const QMetaObject* metaObject = m_qobject ? m_qobject->metaObject() : NULL;
+    return methods(m_qobject ? m_qobject->metaObject() : NULL, key);
+}
+
+namespace {
+
+/**
+ *  @struct MetaMethodIndex
+ *  @brief 单个元对象的方法索引，每个类仅在首次查找方法时建立一次
+ */
+struct MetaMethodIndex
+{
+    QHash<QString, QList<int> > names;      //!< 方法名称到全部同名方法序号的映射（按序号升序）
+    QHash<QString, int>         signatures; //!< 规范化的方法签名到方法序号的映射
+};
+
+typedef QHash<const QMetaObject*, MetaMethodIndex> MetaMethodIndexHash;
+
+// 对象的创建及信号/槽的连接均在GUI线程中执行，因此不需要加锁
+Q_GLOBAL_STATIC(MetaMethodIndexHash, metaMethodIndexes)
+
+}
+
+QList<QMetaMethod> ObjectContext::methods( const QMetaObject* metaObject, const QString& key )
+{
+    QList<QMetaMethod> matchList;
     if (metaObject == NULL) {
-        return QList<QMetaMethod>();
+        return matchList;
     }
 
-    int methodCount = metaObject->methodCount();
-    bool fuzzyMatch = !key.contains(QLatin1Char('('));
-    QList<QMetaMethod> fuzzyMatchList;
-    for (int i = 0; i < methodCount; i++)
+    MetaMethodIndexHash::iterator indexIter = metaMethodIndexes()->find(metaObject);
+    if (indexIter == metaMethodIndexes()->end())
     {
-        QMetaMethod method = metaObject->method(i);
+        MetaMethodIndex index;
+        int methodCount = metaObject->methodCount();
+        for (int i = 0; i < methodCount; i++)
+        {
+            QMetaMethod method = metaObject->method(i);
+            index.names[QString::fromLatin1(method.name())].push_back(i);
+
+            // 子类重新声明的同名方法，仍以序号较小（先出现）者为准
+            QString signature = QString::fromLatin1(method.methodSignature());
+            if (!index.signatures.contains(signature)) {
+                index.signatures.insert(signature, i);
+            }
+        }
+        indexIter = metaMethodIndexes()->insert(metaObject, index);
+    }
 
-        if (fuzzyMatch)
+    bool fuzzyMatch = !key.contains(QLatin1Char('('));
+    if (fuzzyMatch)
+    {
+        foreach (int methodIndex, indexIter->names.value(key))
         {
-            if (key == method.name()) 
-                fuzzyMatchList.push_back(method);
+            matchList.push_back(metaObject->method(methodIndex));
         }
-        else
+    }
+    else
+    {
+        // 不使用模糊匹配时，仅有一个匹配结果；书写不规范的签名（例如含有空格）需要先规范化
+        QHash<QString, int>::const_iterator iter = indexIter->signatures.constFind(key);
+        if (iter == indexIter->signatures.constEnd())
         {
-            if (key == method.methodSignature()) 
-            {
-                fuzzyMatchList.push_back(method);
-                // 不使用模糊匹配时，一般仅有一个匹配结果，为了提高效率，直接返回 [5/8/2016 CHH513]
-                break;
-            }
+            QString signature = QString::fromLatin1(QMetaObject::normalizedSignature(key.toLatin1().constData()));
+            iter = indexIter->signatures.constFind(signature);
         }
+        if (iter != indexIter->signatures.constEnd()) {
+            matchList.push_back(metaObject->method(iter.value()));
+        }
+    }
+
+    return matchList;
+}
+
+
+ObjectContextPool::ObjectContextPool() : m_used(0)
+{
+
+}
+
+ObjectContextPool::~ObjectContextPool()
+{
+    release();
+}
+
+ObjectContext* ObjectContextPool::alloc( const QString& parentKey, const QJsonValue& jsonValue )
+{
+    ObjectContext* objectContext = NULL;
+
+    if (!m_freeList.isEmpty())
+    {
+        // 复用已经释放的槽位，释放时已经放入了一个空的对象上下文，这里需要先析构
+        objectContext = m_freeList.back();
+        m_freeList.pop_back();
+        objectContext->~ObjectContext();
+    }
+    else
+    {
+        if (m_used >= m_chunks.size() * ChunkSize)
+        {
+            void* chunk = ::operator new(sizeof(ObjectContext) * ChunkSize);
+            m_chunks.push_back(static_cast<ObjectContext*>(chunk));
+        }
+        objectContext = slot(m_used++);
+    }
+
+    return new (objectContext) ObjectContext(parentKey, jsonValue);
+}
+
+void ObjectContextPool::free( ObjectContext* objectContext )
+{
+    if (objectContext == NULL)
+        return;
+
+    // 槽位中始终保留一个有效的对象，从而使reset/release可以统一析构全部槽位
+    objectContext->~ObjectContext();
+    new (objectContext) ObjectContext();
+    m_freeList.push_back(objectContext);
+}
+
+void ObjectContextPool::reset()
+{
+    for (int i = 0; i < m_used; i++)
+    {
+        slot(i)->~ObjectContext();
+    }
+
+    m_used = 0;
+    m_freeList.clear();
+}
+
+void ObjectContextPool::release()
+{
+    reset();
+
+    foreach (ObjectContext* chunk, m_chunks)
+    {
+        ::operator delete(chunk);
+    }
+    m_chunks.clear();
+}
+
+void ObjectContextPool::squeeze()
+{
+    // 槽位按顺序分配，仅末尾的内存块可能从未使用
+    int usedChunks = (m_used + ChunkSize - 1) / ChunkSize;
+    for (int i = usedChunks; i < m_chunks.size(); i++)
+    {
+        ::operator delete(m_chunks.at(i));
+    }
+    m_chunks.resize(usedChunks);
+    m_chunks.squeeze();
+    m_freeList.squeeze();
+}
+
+LazyLoadObjectContext::LazyLoadObjectContext( JsonLoader* loader, const QString& parentKey, const QJsonValue& jsonValue ) :
+    ObjectContext(parentKey, jsonValue),
+    m_loader(loader),
+    m_materialized(false),
+    m_parentKeyDeferred(false)
+{
+
+}
+
+bool LazyLoadObjectContext::isLazyLoadObjectContext() const
+{
+    return true;
+}
+
+bool LazyLoadObjectContext::materialize()
+{
+    if (m_materialized)
+        return m_qobject != NULL;
+
+    // 先置标记，避免载入过程中（例如子对象引用本对象）重复载入
+    m_materialized = true;
+    if (m_loader == NULL)
+        return false;
+
+    return m_loader->materialize(*this);
+}
+
+QObject* LazyLoadObjectContext::qObject() const
+{
+    if (!m_materialized) {
+        const_cast<LazyLoadObjectContext*>(this)->materialize();
     }
 
-    return fuzzyMatchList;
+    return m_qobject;
 }
 
 
 PropertyConnection::PropertyConnection( 
     QObject* observerable, const QMetaProperty& observerableProperty, 
     QObject* observer, const QMetaProperty& observerProperty 
-    ) : QObject(NULL),
+    ) : QObject(observer),
     m_observable(observerable),
     m_observerableProperty(observerableProperty),
     m_observer(observer),
@@ -585,7 +1209,8 @@ PropertyConnection::PropertyConnection(
 
 PropertyConnection::~PropertyConnection()
 {
-    if (m_connected)
+    // 被绑定对象可能先于绑定对象销毁，此时连接已被自动断开
+    if (m_connected && m_observable)
     {
         QMetaMethod notifier = m_observerableProperty.notifySignal();
         const QMetaObject* thisMetaObject = metaObject();
@@ -615,7 +1240,11 @@ PropertyConnection* PropertyContext::addObserver( QObject* observer, const QMeta
 }
 
 
-int MethodConnection::connect(QObject* objectA, const QList<QMetaMethod>& methodsA, QObject* objectB, const QList<QMetaMethod>& methodsB)
+int MethodConnection::connect(
+    QObject* objectA, const QList<QMetaMethod>& methodsA, 
+    QObject* objectB, const QList<QMetaMethod>& methodsB, 
+    QList<QMetaObject::Connection>* connections
+    )
 {
     int count = 0;
 
@@ -634,18 +1263,21 @@ int MethodConnection::connect(QObject* objectA, const QList<QMetaMethod>& method
                 continue;
 
             QMetaMethod::MethodType typeB = methodB.methodType();
-            bool ok = false;
+            QMetaObject::Connection connection;
             if (typeA == QMetaMethod::Signal && typeB == QMetaMethod::Slot)
             {
-                ok = QObject::connect(objectA, methodA, objectB, methodB);
+                connection = QObject::connect(objectA, methodA, objectB, methodB);
             }
             else if (typeB == QMetaMethod::Signal && typeA == QMetaMethod::Slot)
             {
-                ok = QObject::connect(objectB, methodB, objectA, methodA);
+                connection = QObject::connect(objectB, methodB, objectA, methodA);
             }
 
-            if (ok)
+            if (connection)
             {
+                if (connections) {
+                    connections->push_back(connection);
+                }
                 count++;
 #if 1
                 //  目前发现对于有默认参数的信号/槽，若多次绑定，会被多次激活，须深度了解Qt的槽的激活实现方式
@@ -683,6 +1315,8 @@ bool MethodConnection::matchSignature( const QByteArray& signatureA, const QByte
 int                     ObjectType::s_currentTypeId = ObjectType::ObjectTypeIdBase; 
 QHash<QString, int>     ObjectType::s_nameIdMap;
 QVector<ObjectFactory*> ObjectType::s_factories;
+QVector<ObjectTypeInfo> ObjectType::s_factoryTypeInfos;
+QVector<ObjectTypeInfo> ObjectType::s_metaTypeInfos;
 
 int ObjectType::registerFactory(const QString& typeName, ObjectFactory* factory)
 {
@@ -691,10 +1325,115 @@ int ObjectType::registerFactory(const QString& typeName, ObjectFactory* factory)
     Q_ASSERT(s_factories.size() == typeId - ObjectTypeIdBase);
     s_factories.push_back(factory);
     s_nameIdMap.insert(typeName, typeId);
+    s_factoryTypeInfos.push_back(resolveTypeInfo(typeId));
 
     return typeId;
 }
 
+const ObjectTypeInfo& ObjectType::typeInfo( int objectType )
+{
+    static const ObjectTypeInfo unresolvedTypeInfo;
+
+    if (objectType >= ObjectTypeIdBase)
+    {
+        int index = objectType - ObjectTypeIdBase;
+        return index < s_factoryTypeInfos.size() ? s_factoryTypeInfos.at(index) : unresolvedTypeInfo;
+    }
+    else if (objectType <= QMetaType::UnknownType)
+    {
+        return unresolvedTypeInfo;
+    }
+
+    if (objectType >= s_metaTypeInfos.size()) {
+        s_metaTypeInfos.resize(objectType + 1);
+    }
+    ObjectTypeInfo& info = s_metaTypeInfos[objectType];
+    if (!info.resolved) {
+        // 尚未注册的类型无法解析，下次查询时重新尝试
+        info = resolveTypeInfo(objectType);
+    }
+    return info;
+}
+
+ObjectTypeInfo ObjectType::resolveTypeInfo( int objectType )
+{
+    ObjectTypeInfo info;
+
+    if (objectType >= ObjectTypeIdBase)
+    {
+        // 默认使用自定义对象工厂创建的对象全部是QObject
+        info.resolved    = true;
+        info.isQObject   = true;
+        info.pointerType = objectType;
+        info.factory     = factory(objectType);
+        info.metaObject  = info.factory ? info.factory->metaObject() : NULL;
+    }
+    else if (objectType < QMetaType::User)
+    {
+        info.resolved    = true;
+        info.isQObject   = objectType == QMetaType::QObjectStar;
+        info.pointerType = objectType;
+        info.metaObject  = QMetaType::metaObjectForType(objectType);
+    }
+    else
+    {
+        const char* metaTypeString = QMetaType::typeName(objectType);
+        if (metaTypeString == NULL) {
+            // 无法识别的类型
+            return info;
+        }
+
+        int pointerMetaType = objectType;
+        QLatin1String metaTypeName(metaTypeString);
+        int metaTypeNameLength = metaTypeName.size();
+        if (metaTypeString[metaTypeNameLength - 1] != '*') 
+        {
+            // 通常指针类型紧随对象类型注册（见REGISTER_METATYPE_X），首先尝试该类型id
+            pointerMetaType = objectType - 1;
+
+            const char* guessedPointerMetaTypeString = QMetaType::typeName(pointerMetaType);
+            bool bingo = guessedPointerMetaTypeString != NULL
+                && int(strlen(guessedPointerMetaTypeString)) == metaTypeNameLength + 1
+                && guessedPointerMetaTypeString[metaTypeNameLength] == '*'
+                && strncmp(guessedPointerMetaTypeString, metaTypeString, metaTypeNameLength) == 0;
+
+            if (!bingo)
+            {
+                QString pointerMetaTypeName = QString(metaTypeName).append(QLatin1Char('*'));
+                pointerMetaType = QMetaType::type(pointerMetaTypeName.toLatin1().constData());
+            }
+        }
+
+        const QMetaObject* metaObject = QMetaType::metaObjectForType(pointerMetaType);
+        if (metaObject == NULL)
+        {
+            // 重复注册的类，其对应的MetaObject可能与自身的metaType不对应
+            QString pointerMetaTypeName = QString(metaTypeName).append(QLatin1Char('*'));
+            pointerMetaType = QMetaType::type(pointerMetaTypeName.toLatin1().constData());
+            metaObject = QMetaType::metaObjectForType(pointerMetaType);
+        }
+
+        // 从QObject继承的对象，至少包含objectName属性，
+        // 因此如果某个对象没有属性，则不是QObject的子类，也就不需要创建对象
+        // 此类对象多为数据，例如QString，QRect，QFont等
+        info.resolved    = true;
+        info.isQObject   = metaObject != NULL && metaObject->propertyCount() >= 1;
+        info.pointerType = pointerMetaType;
+        info.metaObject  = metaObject;
+    }
+
+    for (const QMetaObject* superClass = info.metaObject; superClass; superClass = superClass->superClass())
+    {
+        if (superClass == &QWidget::staticMetaObject) 
+        {
+            info.isWidget = true;
+            break;
+        }
+    }
+
+    return info;
+}
+
 ObjectFactory* ObjectType::factory( int objectType )
 {
     if (objectType >= ObjectTypeIdBase)
@@ -775,6 +1514,146 @@ const QMetaObject* ObjectType::metaObjectForType( int objectType )
     return QMetaType::metaObjectForType(objectType);
 }
 
+ObjectPoolTable::~ObjectPoolTable()
+{
+    clear();
+}
+
+void ObjectPoolTable::setCapacity(int objectType, int capacity)
+{
+    const ObjectTypeInfo& info = ObjectType::typeInfo(objectType);
+    if (!info.isQObject || info.metaObject == NULL)
+    {
+        qCritical() << "Object pool is only available for registered QObject types, type id:" << objectType;
+        return;
+    }
+
+    if (capacity <= 0)
+    {
+        QHash<int, ObjectPool>::iterator poolIter = m_pools.find(objectType);
+        if (poolIter != m_pools.end())
+        {
+            qDeleteAll(poolIter.value().objects);
+            m_pools.erase(poolIter);
+        }
+        m_pooledTypes.remove(info.metaObject);
+        return;
+    }
+
+    ObjectPool& pool = m_pools[objectType];
+    pool.capacity = capacity;
+    pool.typeId   = objectType;
+    while (pool.objects.size() > capacity) {
+        delete pool.objects.takeLast();
+    }
+    m_pooledTypes.insert(info.metaObject, objectType);
+}
+
+int ObjectPoolTable::capacity(int objectType) const
+{
+    QHash<int, ObjectPool>::const_iterator poolIter = m_pools.constFind(objectType);
+    return poolIter != m_pools.constEnd() ? poolIter.value().capacity : 0;
+}
+
+QObject* ObjectPoolTable::take(int objectType)
+{
+    if (m_pools.isEmpty())
+        return NULL;
+
+    QHash<int, ObjectPool>::iterator poolIter = m_pools.find(objectType);
+    if (poolIter == m_pools.end() || poolIter.value().objects.isEmpty())
+        return NULL;
+
+    return poolIter.value().objects.takeLast();
+}
+
+void ObjectPoolTable::captureDefaults(int objectType, const QObject* object)
+{
+    if (object == NULL || m_pools.isEmpty())
+        return;
+
+    // 回收时需要恢复的初始属性值，从该类型首个新建的对象读取
+    QHash<int, ObjectPool>::iterator poolIter = m_pools.find(objectType);
+    if (poolIter == m_pools.end() || !poolIter.value().defaultValues.isEmpty())
+        return;
+
+    ObjectPool& pool = poolIter.value();
+    const QMetaObject* metaObject = object->metaObject();
+    int count = metaObject->propertyCount();
+    pool.defaultValues.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        QMetaProperty property = metaObject->property(i);
+        if (property.isWritable() && !property.isResettable()) {
+            pool.defaultValues[i] = property.read(object);
+        }
+    }
+}
+
+bool ObjectPoolTable::recycle(QObject* object)
+{
+    if (object == NULL || m_pooledTypes.isEmpty())
+        return false;
+
+    const QMetaObject* metaObject = object->metaObject();
+    QHash<const QMetaObject*, int>::const_iterator typeIter = m_pooledTypes.constFind(metaObject);
+    if (typeIter == m_pooledTypes.constEnd())
+        return false;
+
+    // 使能对象池之前创建的对象无从得知初始属性值，不能回收
+    ObjectPool& pool = m_pools[typeIter.value()];
+    if (pool.objects.size() >= pool.capacity || pool.defaultValues.isEmpty())
+        return false;
+
+    // 属性绑定以被绑定对象为父对象，随之一并销毁即断开，对象自身建立的连接需要保留
+    qDeleteAll(object->findChildren<PropertyConnection*>(QString(), Qt::FindDirectChildrenOnly));
+
+    bool isWidget = object->isWidgetType();
+    if (isWidget)
+    {
+        // 脱离父控件时，未隐藏的控件被隐藏但不会被标记为显式隐藏，再次使用时与新建的控件一样随父控件显示，
+        // 因此显式隐藏的控件需要先恢复显示；顶层控件总是需要显式显示，直接隐藏即可
+        QWidget* widget = static_cast<QWidget*>(object);
+        if (widget->parentWidget() && widget->isHidden()) {
+            widget->show();
+        } else if (!widget->parentWidget() && widget->isVisible()) {
+            widget->hide();
+        }
+        widget->setParent(NULL);
+    }
+    else
+    {
+        object->setParent(NULL);
+    }
+
+    // 仅写入已经改变的属性，可重置的属性直接重置，控件的可见性已在脱离父控件时处理
+    int count = qMin(metaObject->propertyCount(), pool.defaultValues.size());
+    for (int i = 0; i < count; i++)
+    {
+        QMetaProperty property = metaObject->property(i);
+        if (isWidget && qstrcmp(property.name(), "visible") == 0) {
+            continue;
+        } else if (property.isResettable()) {
+            property.reset(object);
+        } else if (pool.defaultValues.at(i).isValid() && property.read(object) != pool.defaultValues.at(i)) {
+            property.write(object, pool.defaultValues.at(i));
+        }
+    }
+
+    pool.objects.push_back(object);
+    return true;
+}
+
+void ObjectPoolTable::clear()
+{
+    QHash<int, ObjectPool>::iterator poolIter = m_pools.begin();
+    for (; poolIter != m_pools.end(); ++poolIter)
+    {
+        qDeleteAll(poolIter.value().objects);
+        poolIter.value().objects.clear();
+    }
+}
+
 /*********************************************************************************************************
 ** End of file
 *********************************************************************************************************/
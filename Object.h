@@ -24,12 +24,24 @@
 #include <QMetaObject>
 #include <QMetaProperty>
 #include <QMetaMethod>
+#include <QPointer>
 
 class Object;
 class ObjectContext;
+class JsonLoader;
 
 #include "JsonLoader_p.h"
 
+/**
+ *  @struct ObjectIdScope
+ *  @brief 对象id的作用域索引，登记作用域根对象之下全部对象的id，嵌套作用域内部的对象登记在嵌套作用域中
+ */
+struct ObjectIdScope
+{
+    QMultiHash<QString, Object*>    ids;            //!< 作用域内对象的id索引，允许同名对象
+    QList<Object*>                  childScopes;    //!< 直接嵌套的作用域根对象
+};
+
 class Object 
 {
 public:
@@ -38,6 +50,14 @@ public:
      */
     Object();
 
+    /**
+     * 复制对象时不复制id作用域索引，其中登记的是原对象树中的对象
+     */
+    Object(const Object& other);
+    Object& operator=(const Object& other);
+
+    ~Object();
+
 public: 
     /**
      * 向上查找指定的对象
@@ -116,11 +136,74 @@ public:
      */
     QList<Object*> children() const;
 
+    /**
+     * 根据id查找直接子对象（使用子对象的id索引），存在多个同名子对象时返回最先添加的子对象
+     * @param[in]    objectName 对象名称
+     * @return       查找到的对象指针，未找到则返回NULL
+     * @note         来自objectName的id可能在加入索引之后才被设置或修改，此时退化为顺序查找并修正索引
+     */
+    Object* childById(const QString& objectName) const;
+
+    /**
+     * 将本对象设置为id作用域的根对象，其下对象的id改为登记在本对象的作用域索引中，
+     * 本对象自身的id仍登记在外层作用域中
+     */
+    void setIdScope();
+
+    /**
+     * 在本对象的id作用域及其嵌套的作用域中查找指定的对象，外层作用域优先，
+     * 同一作用域中存在多个同名对象时返回层级最浅者
+     * @param[in]    objectName 对象名称
+     * @return       查找到的对象指针，未找到则返回NULL
+     * @note         本对象不是作用域根对象时退化为findDownwards
+     */
+    Object* findInIdScope(const QString& objectName) const;
+
+    /**
+     * 对象的id（来自objectName）在载入器之外被修改后调用，同步父对象及所在作用域的id索引
+     * @param[in]    oldId  对象原来的id
+     */
+    void updateId(const QString& oldId);
+
+protected: 
+    /**
+     * 更新子对象的id索引，在子对象的id改变时调用
+     * @param[in]    child  子对象
+     * @param[in]    oldId  子对象原来的id
+     */
+    void updateChildIdIndex(Object* child, const QString& oldId);
+
+    /**
+     * 从id索引中移除一个子对象，若存在其他同名子对象则使用其替代
+     * @param[in]    child  子对象
+     * @param[in]    id     子对象的id
+     */
+    void removeChildIdIndex(Object* child, const QString& id);
+
+    /**
+     * 获取本对象的子对象所在的id作用域的根对象，即最近的作为作用域根对象的本对象或祖先对象
+     */
+    Object* childIdScope() const;
+
+    /**
+     * 将一个对象及其子对象树登记到本对象的作用域索引中，遇到嵌套作用域时仅登记其根对象
+     */
+    void registerIds(Object* object);
+
+    /**
+     * 从本对象的作用域索引中移除一个对象及其子对象树
+     */
+    void unregisterIds(Object* object);
+
 protected: 
     QObject*        m_qobject;              //!< 对应的QObject对象
     Object*         m_parent;               //!< 父对象
     QString         m_id;                   //!< 对象名称（id）
     QList<Object*>  m_children;             //!< 全部子对象
+    mutable QHash<QString, Object*> m_childIdIndex; //!< 子对象的id索引，用于加速按名称查找
+    int             m_nameIdChildCount;     //!< 未显式指定id（id来自objectName）的子对象个数
+    ObjectIdScope*  m_idScope;              //!< 作用域根对象的id索引，非作用域根对象为NULL
+    QString         m_scopedId;             //!< 登记在所在作用域索引中的id
 };
 
 class ObjectContext;
@@ -144,9 +227,74 @@ public:
     }
 };
 
-typedef QList< KeyObjectContextPair > KeyObjectContextMap;
-typedef QList< KeyObjectContextPair >::iterator KeyObjectContextMapIter;
-typedef QList< KeyObjectContextPair >::const_iterator KeyObjectContextMapConstIter;
+/**
+ *  @class KeyObjectContextMap
+ *  @brief 保持插入顺序的Key-ObjectContext列表，Key较多时自动建立hash索引，从而加快按Key查找的速度
+ *  @note  索引仅记录每个Key首次出现的位置（与顺序查找的结果一致），删除元素时仅更新其后元素的位置
+ */
+class KeyObjectContextMap : private QList<KeyObjectContextPair>
+{
+public:
+    enum 
+    {
+        IndexThreshold = 8                  //!< Key个数达到此值时才建立hash索引，Key较少时顺序查找更快
+    };
+
+    typedef QList<KeyObjectContextPair>::iterator       iterator;
+    typedef QList<KeyObjectContextPair>::const_iterator const_iterator;
+
+    KeyObjectContextMap() : m_indexDirty(true)
+    {
+    }
+
+    // 只公开不会改变Key的位置的操作，增删元素必须经过push_back/erase/clear以维护索引
+    using QList<KeyObjectContextPair>::begin;
+    using QList<KeyObjectContextPair>::end;
+    using QList<KeyObjectContextPair>::cbegin;
+    using QList<KeyObjectContextPair>::cend;
+    using QList<KeyObjectContextPair>::size;
+    using QList<KeyObjectContextPair>::isEmpty;
+    using QList<KeyObjectContextPair>::at;
+
+    iterator find(const QString& key)
+    {
+        int index = indexOf(key);
+        return index >= 0 ? begin() + index : end();
+    }
+
+    const_iterator constFind(const QString& key) const
+    {
+        int index = indexOf(key);
+        return index >= 0 ? cbegin() + index : cend();
+    }
+
+    void push_back(const KeyObjectContextPair& pair)
+    {
+        QList<KeyObjectContextPair>::push_back(pair);
+        if (!m_indexDirty && !m_index.contains(pair.first)) {
+            m_index.insert(pair.first, size() - 1);
+        }
+    }
+
+    iterator erase(iterator iter);
+
+    void clear()
+    {
+        m_index.clear();
+        m_indexDirty = true;
+        QList<KeyObjectContextPair>::clear();
+    }
+
+protected:
+    int indexOf(const QString& key) const;
+
+private:
+    mutable QHash<QString, int> m_index;        //!< Key到其首次出现位置的索引
+    mutable bool                m_indexDirty;   //!< 索引是否需要重建
+};
+
+typedef KeyObjectContextMap::iterator KeyObjectContextMapIter;
+typedef KeyObjectContextMap::const_iterator KeyObjectContextMapConstIter;
 
 class ObjectContext : public Object
 {
@@ -203,6 +351,11 @@ public:
 
     bool removeChild(const QString& key, ObjectContext* child);
 
+    /*! 
+     * 移除全部子对象上下文，但并不释放它们，通常用于内存池批量释放之前
+     */
+    void clearChildren();
+
     KeyObjectContextMapConstIter findInParent()
     {
         if (!m_parent) {
@@ -221,6 +374,27 @@ public:
     }
 
     
+    /*! 
+     * 是否为延迟载入的对象上下文（LazyLoadObjectContext）
+     */
+    virtual bool isLazyLoadObjectContext() const
+    {
+        return false;
+    }
+
+    /*! 
+     * 记录解析该对象上下文的Key时建立的信号-槽连接，卸载时据此断开
+     */
+    void addConnections(const QList<QMetaObject::Connection>& connections)
+    {
+        m_connections += connections;
+    }
+
+    /*! 
+     * 断开已经记录的全部信号-槽连接
+     */
+    void releaseConnections();
+
     QMetaProperty property(const QString& key) const;
     int propertyType(const QMetaProperty& property) const;
 
@@ -230,6 +404,14 @@ public:
 
 
     QList<QMetaMethod> methods(const QString& key) const;
+
+    /**
+     * 根据名称（模糊匹配）或签名（精确匹配）查找元对象的方法，每个元对象的方法索引仅建立一次
+     * @param[in]    metaObject 元对象
+     * @param[in]    key        方法名称或签名
+     * @return       匹配的方法列表
+     */
+    static QList<QMetaMethod> methods(const QMetaObject* metaObject, const QString& key);
 public:
     QString toString() const;
     static void dumpObjectContext(const ObjectContext& context, bool recursively = true);
@@ -239,25 +421,130 @@ protected:
     QString             m_parentKey;
     QJsonValue          m_value;
     KeyObjectContextMap m_keyObjectContextMap;
+    QList<QMetaObject::Connection> m_connections;   //!< 载入时建立的信号-槽连接
 };
 Q_DECLARE_METATYPE(ObjectContext)
 
+/**
+ *  @class ObjectContextPool
+ *  @brief 对象上下文的内存池，按块（chunk）批量分配内存，分配得到的指针在释放之前始终有效
+ *  @note  单个释放的对象上下文会被回收并在下次分配时复用，全部对象上下文可以通过reset/release一次性释放
+ */
+class ObjectContextPool
+{
+public:
+    enum 
+    {
+        ChunkSize = 1024                    //!< 每个内存块可容纳的对象上下文个数
+    };
+
+    ObjectContextPool();
+    ~ObjectContextPool();
+
+    /*! 
+     * 分配一个对象上下文
+     * @param[in]  parentKey    用于初始化该对象上下文的parentKey
+     * @param[in]  jsonValue    用于初始化该对象上下文的jsonValue
+     * @return     分配得到的对象上下文指针
+     */
+    ObjectContext* alloc(const QString& parentKey, const QJsonValue& jsonValue);
+
+    /*! 
+     * 释放一个对象上下文，其内存将在下次分配时复用
+     * @param[in]  objectContext 由本内存池分配的对象上下文指针
+     */
+    void free(ObjectContext* objectContext);
+
+    /*! 
+     * 析构全部对象上下文，但保留已经分配的内存块，用于下一次载入
+     */
+    void reset();
+
+    /*! 
+     * 析构全部对象上下文，并释放全部内存块
+     */
+    void release();
+
+    /*! 
+     * 释放尚未使用过的内存块，已经分配的对象上下文保持不变
+     */
+    void squeeze();
+
+    /*! 
+     * 获取当前正在使用的对象上下文个数
+     */
+    int count() const
+    {
+        return m_used - m_freeList.size();
+    }
+
+private:
+    Q_DISABLE_COPY(ObjectContextPool)
+
+    ObjectContext* slot(int index) const
+    {
+        return m_chunks.at(index / ChunkSize) + index % ChunkSize;
+    }
+
+private:
+    QVector<ObjectContext*> m_chunks;       //!< 内存块列表，每块可容纳ChunkSize个对象上下文
+    QVector<ObjectContext*> m_freeList;     //!< 已释放、可复用的对象上下文
+    int                     m_used;         //!< 已经使用过的槽位个数（包括已释放的槽位）
+};
+
 class JsonFileObjectContext : public ObjectContext
 {
 
 };
 
+/**
+ *  @class LazyLoadObjectContext
+ *  @brief 延迟载入的对象上下文，对应JSON中指定了".lazy": true的对象，载入时仅保留其JSON数据，
+ *         首次访问其QObject（例如通过findObject、名称引用）时才创建对象并展开子对象上下文树
+ *  @note  由JsonLoader直接分配及释放，不使用对象上下文内存池
+ */
 class LazyLoadObjectContext: public ObjectContext
 {
 public:
-    LazyLoadObjectContext();
+    LazyLoadObjectContext(JsonLoader* loader, const QString& parentKey, const QJsonValue& jsonValue);
 
     bool isLazyLoadObjectContext() const;
 
+    /*! 
+     * 是否已经载入（无论成功与否，仅载入一次）
+     */
+    bool isMaterialized() const
+    {
+        return m_materialized;
+    }
+
+    /*! 
+     * Getter/Setter for parentKeyDeferred：父对象上下文中所属的Key是否因本对象尚未载入而被推迟解析
+     */
+    bool isParentKeyDeferred() const
+    {
+        return m_parentKeyDeferred;
+    }
+    void setParentKeyDeferred(bool deferred)
+    {
+        m_parentKeyDeferred = deferred;
+    }
+
+    /*! 
+     * 立即载入本对象及其子对象树
+     * @return     创建了QObject对象则返回true
+     */
+    bool materialize();
+
+    /*! 
+     * 获取对象对应的QObject对象，尚未载入时先载入
+     */
     QObject* qObject() const;
 
 protected:
-    const int m_magic;
+    JsonLoader*     m_loader;
+    bool            m_materialized;
+    bool            m_parentKeyDeferred;
 };
 
 class PropertyConnection : public QObject
@@ -286,7 +573,7 @@ protected:
     Q_SLOT void onNotify() const;
 
 protected:
-    QObject* m_observable;
+    QPointer<QObject> m_observable;
     QObject* m_observer;
     QMetaProperty m_observerableProperty;
     QMetaProperty m_observerProperty;
@@ -338,11 +625,13 @@ public:
      * @param[in]  methodsA 模糊信号/槽A
      * @param[in]  objectB  对象B
      * @param[in]  methodsB 模糊信号/槽B
+     * @param[out] connections 追加成功建立的连接，可为NULL
      * @return     成功绑定的信号-槽对的个数
      */
     static int connect(
         QObject* objectA, const QList<QMetaMethod>& methodsA,
-        QObject* objectB, const QList<QMetaMethod>& methodsB
+        QObject* objectB, const QList<QMetaMethod>& methodsB,
+        QList<QMetaObject::Connection>* connections = NULL
         );
 
 protected:
@@ -435,6 +724,102 @@ public:
     }
 };
 
+/**
+ *  @struct ObjectTypeInfo
+ *  @brief 对象类型的分类信息，由ObjectType在注册类型或首次查询该类型时生成并缓存
+ */
+struct ObjectTypeInfo
+{
+    ObjectTypeInfo() 
+        : resolved(false)
+        , isQObject(false)
+        , isWidget(false)
+        , pointerType(QMetaType::UnknownType)
+        , metaObject(NULL)
+        , factory(NULL)
+    {
+    }
+
+    bool               resolved;            //!< 是否已经生成分类信息
+    bool               isQObject;           //!< 是否为QObject的子类（需要使用{}创建的对象）
+    bool               isWidget;            //!< 是否为QWidget的子类
+    int                pointerType;         //!< 对应的指针类型id
+    const QMetaObject* metaObject;          //!< 对应的元对象
+    ObjectFactory*     factory;             //!< 自定义对象工厂，非自定义类型为NULL
+};
+
+/**
+ *  @struct ObjectPool
+ *  @brief 单一类型的QObject对象池，回收的对象恢复为刚创建时的属性值后等待再次使用
+ */
+struct ObjectPool
+{
+    ObjectPool() : capacity(0), typeId(QMetaType::UnknownType)
+    {
+    }
+
+    int                capacity;            //!< 最多保留的对象个数
+    int                typeId;              //!< 对象类型id
+    QList<QObject*>    objects;             //!< 空闲的对象
+    QVector<QVariant>  defaultValues;       //!< 刚创建的对象的属性值，以属性序号为下标，首次创建该类型的对象时记录
+};
+
+/**
+ *  @class ObjectPoolTable
+ *  @brief 各类型的QObject对象池，由JsonLoader持有并仅在其所在线程中使用，析构时销毁全部空闲对象
+ */
+class ObjectPoolTable
+{
+public:
+    ObjectPoolTable()
+    {
+    }
+
+    ~ObjectPoolTable();
+
+    /*! 
+     * 设置指定类型的对象池容量，默认为0即不使用对象池，仅适用于QObject的子类
+     * @param[in]  objectType 类型id
+     * @param[in]  capacity   最多保留的空闲对象个数，为0时销毁池中的全部对象并禁用对象池
+     */
+    void setCapacity(int objectType, int capacity);
+    int  capacity(int objectType) const;
+
+    /*! 
+     * 从对象池中取出一个空闲对象
+     * @param[in]  objectType 类型id
+     * @return     该类型未使能对象池或池中没有空闲对象时返回NULL
+     */
+    QObject* take(int objectType);
+
+    /*! 
+     * 记录新建对象的属性值作为该类型的初始属性值，仅在该类型使能了对象池且尚未记录时生效
+     * @param[in]  objectType 类型id
+     * @param[in]  object     刚创建的对象
+     */
+    void captureDefaults(int objectType, const QObject* object);
+
+    /*! 
+     * 回收一个对象：断开其属性绑定，脱离父对象，恢复初始属性值后放入对应类型的对象池
+     * @param[in]  object 对象，其类型必须与使能了对象池的类型完全一致（不包括子类）
+     * @return     对象池已满或该类型未使能对象池时返回false，此时调用者负责销毁该对象
+     * @note       对象自身建立的连接予以保留，其他由调用者建立的信号-槽连接须在回收之前断开
+     */
+    bool recycle(QObject* object);
+
+    /*! 
+     * 销毁全部对象池中的空闲对象，池的容量保持不变
+     */
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ObjectPoolTable)
+
+private:
+    QHash<int, ObjectPool>          m_pools;        //!< 使能了对象池的类型的对象池，以类型id为Key
+    QHash<const QMetaObject*, int>  m_pooledTypes;  //!< 使能了对象池的类型的元对象到类型id的映射，用于回收
+};
+
 class JSON_LOADER_EXPORT ObjectType
 {
 public:
@@ -453,6 +838,13 @@ public:
 
     static const QMetaObject* metaObjectForType(int objectType);
 
+    /*! 
+     * 获取对象类型的分类信息，首次查询后缓存，此后仅需一次数组索引
+     * @param[in]  objectType 类型id
+     * @return     分类信息，无法识别的类型返回未解析（resolved为false）的信息
+     */
+    static const ObjectTypeInfo& typeInfo(int objectType);
+
     
     /*! 
      * 注册一个简单对象（不适用QMetaObject的对象，例如QFont、QDateTime以及自定义类）
@@ -480,10 +872,13 @@ public:
 protected:
     static int registerFactory(const QString& typeName, ObjectFactory* factory);
     static ObjectFactory* factory(int objectType);
+    static ObjectTypeInfo resolveTypeInfo(int objectType);
 
 private:
     static QHash<QString, int>     s_nameIdMap;
     static QVector<ObjectFactory*> s_factories;
+    static QVector<ObjectTypeInfo> s_factoryTypeInfos;  //!< 自定义类型的分类信息，与s_factories一一对应
+    static QVector<ObjectTypeInfo> s_metaTypeInfos;     //!< QMetaType类型的分类信息，以类型id为下标
     static int                     s_currentTypeId;
 };
 
@@ -37,15 +37,15 @@
 #include <QDebug>
 
 
-void IParser::error( int code, const QString& message ) const
+void IParser::error( int code, const QString& message, ObjectContext* context, const QString& key, const QString& value ) const
 {
     if (!m_loader) 
     {
-        qDebug() << "Parser error [" << code << "]: " << message;
+        qDebug() << "Parser error [" << code << "]: " << (context ? message.arg(key, value, context->toString()) : message);
         return;
     }
 
-    emit m_loader->error(code, message);
+    m_loader->raiseError(code, message, context, key, value);
 }
 
 QVariant IParser::parseValue( ObjectContext& objectContext, int metaTypeHint /*= QMetaType::UnknownType*/ ) const
@@ -90,9 +90,48 @@ QVariant IParser::loadJsonFile(const QString& jsonFile, ObjectContext& parentCon
         return QVariant();
     }
 
+    LOAD_STATS_COUNT(NestedFileCounter);
     return m_loader->load(jsonFile, parentContext, parentKey, QList<ObjectContext*>(), QList<ObjectContext*>());
 }
 
+bool IParser::deferPropertyWrite( QObject* qObject, const QMetaProperty& property, const QVariant& value ) const
+{
+    if (!m_loader) {
+        return false;
+    }
+
+    return m_loader->deferPropertyWrite(qObject, property, value);
+}
+
+QObject* IParser::takePooledObject( int objectType ) const
+{
+    if (!m_loader) {
+        return NULL;
+    }
+
+    return m_loader->m_objectPools.take(objectType);
+}
+
+void IParser::capturePoolDefaults( int objectType, const QObject* object ) const
+{
+    if (!m_loader) {
+        return;
+    }
+
+    m_loader->m_objectPools.captureDefaults(objectType, object);
+}
+
+#if ENABLE_LOAD_PROFILING
+void IParser::addLoadStatsCount( int counter ) const
+{
+    if (!m_loader) {
+        return;
+    }
+
+    m_loader->addLoadStatsCount(JsonLoader::LoadCounter(counter));
+}
+#endif
+
 bool IParser::parseObjectAndContents( 
     ObjectContext* objectContext, 
     const QString& valueString, 
@@ -196,8 +235,14 @@ bool ObjectCreator::parse( ObjectContext* objectContext ) const
         Q_ASSERT_X(isQObject(metaType), "ObjectCreator::parse", "ObjectCreator can ONLY create QObjects.");
 #endif
 
-        void* ptr = CREATE_METATYPE_OBJECT_METHOD(metaType);
-        qObject = reinterpret_cast<QObject*>(ptr);
+        // 使能了对象池的类型优先复用回收的对象
+        qObject = takePooledObject(metaType);
+        if (qObject == NULL)
+        {
+            void* ptr = CREATE_METATYPE_OBJECT_METHOD(metaType);
+            qObject = reinterpret_cast<QObject*>(ptr);
+            capturePoolDefaults(metaType, qObject);
+        }
         objectContext->setQObject(qObject);
     }
 
@@ -209,72 +254,8 @@ bool ObjectCreator::parse( ObjectContext* objectContext ) const
 
 bool ObjectCreator::isQObject( int metaType ) const
 {
-#if ENABLE_CUSTOM_OBJECT_FACTORY
-    // 默认使用自定义对象工厂创建的对象全部是QObject
-    if (metaType >= ObjectType::ObjectTypeIdBase)
-        return true;
-#endif
-
-    if (metaType < QMetaType::User) {
-        return metaType == QMetaType::QObjectStar;
-    }
-
-    // FIXME: 此处重复获取了部分信息，考虑优化
-    const char* metaTypeString = QMetaType::typeName(metaType);
-    if (metaTypeString == NULL) {
-        // 无法识别的类型，默认返回false
-        return false;
-    }
-
-    int pointerMetaType = metaType;
-    QLatin1String metaTypeName(metaTypeString);
-    int metaTypeNameLength = metaTypeName.size();
-    if (metaTypeString[metaTypeNameLength - 1] != '*') 
-    {
-        pointerMetaType = metaType - 1;
-
-        const char* guessedPointerMetaTypeString = QMetaType::typeName(pointerMetaType);
-        QLatin1String guessedPointerMetaTypeName(guessedPointerMetaTypeString);
-        bool bingo = false;
-        if (guessedPointerMetaTypeName.size() == metaTypeNameLength + 1 && 
-            guessedPointerMetaTypeString[metaTypeNameLength] == '*')
-        {
-            const char* a = metaTypeString;
-            const char* b = guessedPointerMetaTypeString;
-            bingo = true;
-            while (metaTypeNameLength--)
-            {
-                if (*a++ != *b++) {
-                    bingo = false;
-                    break;
-                }
-            }
-        }
-
-        if (!bingo)
-        {
-            QString pointerMetaTypeName = QString(metaTypeName).append(QLatin1Char('*'));
-            pointerMetaType = QMetaType::type(pointerMetaTypeName.toLatin1().constData());
-        }
-    }
-        
-    const QMetaObject* metaObject = GET_METAOBJECT_METHOD(pointerMetaType);
-    if (metaObject == NULL)
-    {
-        // 重复注册的类，其对应的MetaObject可能与自身的metaType不对应
-        QString pointerMetaTypeName = QString(metaTypeName).append(QLatin1Char('*'));
-        pointerMetaType = QMetaType::type(pointerMetaTypeName.toLatin1().constData());
-        metaObject = GET_METAOBJECT_METHOD(pointerMetaType);
-    }
-    if (metaObject != NULL && metaObject->propertyCount() >= 1)
-    {
-        // 从QObject继承的对象，至少包含objectName属性，
-        // 因此如果某个对象没有属性，则不是QObject的子类，也就不需要创建对象
-        // 此类对象多为数据，例如QString，QRect，QFont等
-        return true;
-    }
-
-    return false;
+    // 分类信息在首次查询时生成并缓存，无法识别的类型默认返回false
+    return ObjectType::typeInfo(metaType).isQObject;
 }
 
 bool ObjectCreator::parseIdKey(ObjectContext* objectContext, QObject* qObject) const
@@ -881,10 +862,10 @@ bool PropertyKeyParser::parse(ObjectContext* objectContext, KeyObjectContextMapC
                 {
                     error(
                         JsonLoader::KeyParserError, 
-                        QString("Property type mismatch: Object=%1, Key=%2, Value=%3")
-                        .arg(objectContext->toString())
-                        .arg(key)
-                        .arg(propertyVariant.toString())
+                        QString("Property type mismatch: Object=%3, Key=%1, Value=%2"),
+                        objectContext,
+                        key,
+                        propertyVariant.toString()
                         );
                     return false;
                 }
@@ -899,18 +880,32 @@ bool PropertyKeyParser::parse(ObjectContext* objectContext, KeyObjectContextMapC
         }
     }
 
+    // 事务式构建期间，新建控件的显示推迟至构建提交时
+    if (deferPropertyWrite(qObject, qProperty, propertyVariant)) {
+        return true;
+    }
+
+    // 未显式指定id的对象以objectName作为id，写入后需同步id索引
+    bool idChanged = qObject == objectContext->qObject() && qstrcmp(qProperty.name(), "objectName") == 0;
+    QString oldId = idChanged ? objectContext->id() : QString();
+
     if (!qProperty.write(qObject, propertyVariant))
     {
         error(
             JsonLoader::KeyParserError, 
-            QString("Failed to write property:%1 with value:%2, Object=%3.")
-            .arg(key)
-            .arg(propertyVariant.toString())
-            .arg(objectContext->toString())
+            QString("Failed to write property:%1 with value:%2, Object=%3."),
+            objectContext,
+            key,
+            propertyVariant.toString()
             );
         return false;
     }
 
+    if (idChanged) {
+        objectContext->updateId(oldId);
+    }
+
+    LOAD_STATS_COUNT(PropertyCounter);
     return true;
 }
 
@@ -987,7 +982,10 @@ bool MethodKeyParser::parse( ObjectContext* objectContext, KeyObjectContextMapCo
         return false;
     }
 
-    int connectionCount = MethodConnection::connect(qObject, thisMethods, targetObject, targetMethods);
+    // 记录建立的连接，卸载该对象上下文时断开，而不影响对象自身建立的连接
+    QList<QMetaObject::Connection> connections;
+    int connectionCount = MethodConnection::connect(qObject, thisMethods, targetObject, targetMethods, &connections);
+    objectContext->addConnections(connections);
     if (connectionCount <= 0)
     {
         error(
@@ -1013,16 +1011,40 @@ int ArrayValueParser::elementMetaTypeId( const QString& elementTypeName ) const
 }
 #endif
 
-QVariant StringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+bool ValueTags::contains( const QString& tag ) const
+{
+    if (tag == QLatin1String("tr"))
+        return testFlag(TrTag);
+    if (tag == QLatin1String("date"))
+        return testFlag(DateTag);
+    if (tag == QLatin1String("time"))
+        return testFlag(TimeTag);
+
+    return m_unknownTags.contains(tag);
+}
+
+void ValueTags::add( const QStringRef& tag )
+{
+    if (tag == QLatin1String("tr"))
+        m_knownTags |= TrTag;
+    else if (tag == QLatin1String("date"))
+        m_knownTags |= DateTag;
+    else if (tag == QLatin1String("time"))
+        m_knownTags |= TimeTag;
+    else
+        m_unknownTags.push_back(tag.toString());
+}
+
+QVariant StringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
 {
     return false;
 }
 
-QVariant TranslatedStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+QVariant TranslatedStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
 {
     bool needTranslation = false;
 
-    if (tags.contains("tr")) {
+    if (tags.testFlag(ValueTags::TrTag)) {
         needTranslation = true;
     }
     else
@@ -1044,7 +1066,13 @@ QVariant TranslatedStringValueParser::parse( ObjectContext* objectContext, const
     }
 
     if (!addTranslation(*objectContext)) {
-        error(JsonLoader::TranslationError, QString("Failed to add translation: %1").arg(objectContext->toString()));
+        error(
+            JsonLoader::TranslationError, 
+            QString("Failed to add translation: Key=%1, Value=%2, Object=%3"), 
+            objectContext,
+            objectContext->parentKey(),
+            valueString
+            );
     }
 
     return translate(valueString);
@@ -1056,7 +1084,7 @@ QString TranslatedStringValueParser::translate( const QString& string )
     return qApp->translate("JsonLoader", raw.constData());
 }
 
-QVariant ObjectNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+QVariant ObjectNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
 {
     Object* target = NULL;
 #if 0
@@ -1081,20 +1109,94 @@ ObjectContentStringValueParser::ObjectContentStringValueParser( JsonLoader * loa
 }
 
 
-QVariant EnumNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+namespace {
+
+typedef QHash<QString, int> EnumKeyValueHash;
+typedef QHash<const QMetaObject*, EnumKeyValueHash> MetaEnumKeyValueHash;
+
+// 对象的创建及属性的解析均在GUI线程中执行，因此不需要加锁
+Q_GLOBAL_STATIC(MetaEnumKeyValueHash, metaEnumKeyValues)
+
+/*! 
+ * 根据元对象中的全部枚举类型，将枚举名称转换为枚举值，每个元对象的枚举表仅在首次使用时建立一次
+ * @param[in]  metaObject   元对象
+ * @param[in]  key          枚举名称
+ * @param[out] value        枚举值
+ * @return     转换成功返回true
+ */
+bool enumKeyToValue(const QMetaObject* metaObject, const QString& key, int& value)
 {
+    MetaEnumKeyValueHash::iterator iter = metaEnumKeyValues()->find(metaObject);
+    if (iter == metaEnumKeyValues()->end())
+    {
+        // 与逐一调用QMetaEnum::keysToValue的顺序一致，同名枚举以先出现者为准
+        EnumKeyValueHash keyValues;
+        int enumCount = metaObject->enumeratorCount();
+        for (int i = 0; i < enumCount; i++)
+        {
+            QMetaEnum enumerator = metaObject->enumerator(i);
+            int keyCount = enumerator.keyCount();
+            for (int j = 0; j < keyCount; j++)
+            {
+                QString enumKey = QString::fromLatin1(enumerator.key(j));
+                if (!keyValues.contains(enumKey)) {
+                    keyValues.insert(enumKey, enumerator.value(j));
+                }
+            }
+        }
+        iter = metaEnumKeyValues()->insert(metaObject, keyValues);
+    }
+
+    EnumKeyValueHash::const_iterator keyIter = iter->constFind(key);
+    if (keyIter != iter->constEnd())
+    {
+        value = keyIter.value();
+        return true;
+    }
+
+    // 其他形式的枚举名称（例如带作用域的名称），仍然交由QMetaEnum处理
+    int enumCount = metaObject->enumeratorCount();
+    QByteArray keyData = key.toLatin1();
+    for (int i = 0; i < enumCount; i++)
+    {
+        bool ok = false;
+        value = metaObject->enumerator(i).keysToValue(keyData.constData(), &ok);
+        if (ok) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
+
+QVariant EnumNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
+{
+    // 仅由类名限定的枚举（例如Qt.AlignLeft|Qt.AlignVCenter）的值与上下文无关，可以直接使用缓存的结果
+    QHash<QString, int>::const_iterator cachedIter = m_cachedValues.constFind(valueString);
+    if (cachedIter != m_cachedValues.constEnd()) {
+        return cachedIter.value();
+    }
+
     QObject* qObject = NULL;
     const QMetaObject* metaObject = NULL;
     QString contentName;
     int enumValue = 0;
     bool allOk = true;
     bool isUnregisteredEnum = false;
+    bool cacheable = true;
 
     QStringList parts = valueString.split(QChar('|'), QString::SkipEmptyParts);
     foreach (QString part, parts)
     {
         bool partOk = false;
 
+        // 以对象名称限定的枚举，其值取决于该名称在当前上下文中对应的对象
+        if (qObject != NULL || part.at(0).isLower()) {
+            cacheable = false;
+        }
+
         if (!parseObjectAndContents(objectContext, part, qObject, metaObject, contentName, false))
         {
 //             error(JsonLoader::StringValueParserError, "Failed to parse enum value.");
@@ -1117,20 +1219,11 @@ QVariant EnumNameStringValueParser::parse( ObjectContext* objectContext, const Q
             break;
         }
 
-        int enumCount = metaObject->enumeratorCount();
-        QByteArray keyData = contentName.toLatin1();
-        const char* key = keyData.constData();
-        for (int i = 0; i < enumCount; i++)
+        int value = 0;
+        if (enumKeyToValue(metaObject, contentName, value))
         {
-            QMetaEnum enumerator = metaObject->enumerator(i);
-            bool ok = false;
-            int value = enumerator.keysToValue(key, &ok);
-            if (ok)
-            {
-                enumValue |= value;
-                partOk = true;
-                break;
-            }
+            enumValue |= value;
+            partOk = true;
         }
 
         if (!partOk)
@@ -1165,12 +1258,16 @@ QVariant EnumNameStringValueParser::parse( ObjectContext* objectContext, const Q
             .arg(valueString)
             );
     }
+    else if (cacheable)
+    {
+        m_cachedValues.insert(valueString, enumValue);
+    }
 
     return enumValue;
 }
 
 
-QVariant PropertyNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+QVariant PropertyNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
 {
     QObject* qObject = NULL;
     const QMetaObject* metaObject = NULL;
@@ -1213,7 +1310,7 @@ QVariant PropertyNameStringValueParser::parse( ObjectContext* objectContext, con
 }
 
 
-QVariant MethodNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+QVariant MethodNameStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
 {
     QObject* qObject = NULL;
     const QMetaObject* metaObject = NULL;
@@ -1235,9 +1332,7 @@ QVariant MethodNameStringValueParser::parse( ObjectContext* objectContext, const
         return false;
     }
 
-    ObjectContext tmpObjectContext;
-    tmpObjectContext.setQObject(qObject);
-    QList<QMetaMethod> methods = tmpObjectContext.methods(contentName);
+    QList<QMetaMethod> methods = ObjectContext::methods(qObject->metaObject(), contentName);
     if (!methods.isEmpty())
     {
         MethodContext result;
@@ -1256,13 +1351,13 @@ QVariant MethodNameStringValueParser::parse( ObjectContext* objectContext, const
 }
 
 
-QVariant PixmapStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const QStringList& tags ) const
+QVariant PixmapStringValueParser::parse( ObjectContext* objectContext, const QString& valueString, const ValueTags& tags ) const
 {
     QPixmap pixmap(valueString);
     return QVariant(pixmap);
 }
 
-QVariant SizeStringValueParser::parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const
+QVariant SizeStringValueParser::parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const
 {
     QString     value  = valueString.toLower();
     QStringList values = value.split(QLatin1Char('x'));
@@ -1286,7 +1381,7 @@ QVariant SizeStringValueParser::parse(ObjectContext* objectContext, const QStrin
     return QVariant();
 }
 
-QVariant RectStringValueParser::parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const
+QVariant RectStringValueParser::parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const
 {
     QString     value  = valueString.toLower();
     QStringList values = value.split(QLatin1Char(','));
@@ -1314,7 +1409,7 @@ QVariant RectStringValueParser::parse(ObjectContext* objectContext, const QStrin
     return QVariant();
 }
 
-QVariant DateTimeStringValueParser::parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const
+QVariant DateTimeStringValueParser::parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const
 {
     QDateTime result;
 
@@ -1327,8 +1422,8 @@ QVariant DateTimeStringValueParser::parse(ObjectContext* objectContext, const QS
             "you can write time string as: yyyy-mm-ddTHH:MM:SS.mmm").arg(valueString)
         );
 
-    bool dateOnly = tags.contains("date");
-    bool timeOnly = tags.contains("time");
+    bool dateOnly = tags.testFlag(ValueTags::DateTag);
+    bool timeOnly = tags.testFlag(ValueTags::TimeTag);
     if (dateOnly)
     {
         error(
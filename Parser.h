@@ -46,7 +46,10 @@ public:
 
     }
 
-    void error(int code, const QString& message) const;
+    void error(
+        int code, const QString& message, ObjectContext* context = NULL, 
+        const QString& key = QString(), const QString& value = QString()
+        ) const;
 
     QVariant parseValue(ObjectContext& objectContext, int metaTypeHint = QMetaType::UnknownType) const;
 
@@ -62,6 +65,16 @@ public:
         const QString& parentKey
         ) const;
 
+    bool deferPropertyWrite(QObject* qObject, const QMetaProperty& property, const QVariant& value) const;
+
+    QObject* takePooledObject(int objectType) const;
+
+    void capturePoolDefaults(int objectType, const QObject* object) const;
+
+#if ENABLE_LOAD_PROFILING
+    void addLoadStatsCount(int counter) const;
+#endif
+
 protected:
     bool parseObjectAndContents(
         ObjectContext* objectContext, 
@@ -223,6 +236,7 @@ public:
      * 
      * @param[in]    key	
      * @return       操作成功返回true
+     * @note         匹配结果仅能取决于key本身，JsonLoader将按key缓存匹配结果
      */
     virtual bool matches(const QString& key) const;
 
@@ -376,6 +390,15 @@ public:
         return GET_METATYPE_ID_METHOD(typeName);
     }
 
+    /**
+     * 获取本解析器能够处理的全部容器类型名称，JsonLoader在注册解析器时据此预先建立容器类型到元素类型的映射
+     * @return       容器类型名称列表，例如"QList<QWidget*>"，无法枚举时返回空列表
+     */
+    virtual QStringList containerTypeNames() const
+    {
+        return QStringList();
+    }
+
     virtual int parseArrayElementType(int propertyMetaTypeId, const QString& propertyMetaTypeName) const = 0;
     virtual QVariant parseValue(const QVariantList& valueArray) const = 0;
 };
@@ -404,14 +427,32 @@ public:
         m_typeNamePattern = typeNamePattern;
     }
 
+    virtual QStringList containerTypeNames() const
+    {
+        // 仅支持默认形式的正则表达式，即"Container<(.+)>"
+        static const QString elementPattern = QLatin1String("<(.+)>");
+        QString pattern = m_typeNamePattern.pattern();
+        QString elementTypeName = GET_METATYPE_NAME_METHOD(m_metaType);
+        if (!pattern.endsWith(elementPattern) || elementTypeName.isEmpty())
+            return QStringList();
+
+        QString containerName = pattern.left(pattern.size() - elementPattern.size());
+        QStringList typeNames;
+        typeNames.push_back(containerName + QLatin1Char('<') + elementTypeName + QLatin1Char('>'));
+        if (!elementTypeName.endsWith(QLatin1Char('*')))
+            typeNames.push_back(containerName + QLatin1Char('<') + elementTypeName + QLatin1String("*>"));
+        return typeNames;
+    }
+
     virtual int parseArrayElementType(int propertyMetaTypeId, const QString& propertyMetaTypeName) const
     {
-        // 注意此处不支持多线程 [5/6/2016 CHENHONGHAO]
-        int pos = m_typeNamePattern.indexIn(propertyMetaTypeName);
+        // QRegExp在匹配时会记录捕获结果，使用局部拷贝（共享已编译的正则表达式）以支持多线程
+        QRegExp typeNamePattern = m_typeNamePattern;
+        int pos = typeNamePattern.indexIn(propertyMetaTypeName);
         if (pos < 0)
             return QMetaType::UnknownType;
 
-        QString listMetaTypeName = m_typeNamePattern.cap(1);
+        QString listMetaTypeName = typeNamePattern.cap(1);
         int elementMetaTypeId = ArrayValueParser::elementMetaTypeId(listMetaTypeName);
         if (elementMetaTypeId != QMetaType::UnknownType)
             return elementMetaTypeId;
@@ -463,6 +504,74 @@ DEFINE_GENERIC_CONTAINER_VALUE_PARSER_CLASS(GenericListValueParser,   QList)
 DEFINE_GENERIC_CONTAINER_VALUE_PARSER_CLASS(GenericVectorValueParser, QVector)
 
 
+/**
+ *  @class ValueTags
+ *  @brief Key或者Value中的tags（例如"`tr`Hello"），已知的tag以位标志表示，仅未知的tag保存为字符串
+ */
+class ValueTags
+{
+public:
+    enum KnownTag
+    {
+        NoTag   = 0x0,
+        TrTag   = 0x1,                      //!< `tr`，需要翻译的字符串
+        DateTag = 0x2,                      //!< `date`，仅日期
+        TimeTag = 0x4                       //!< `time`，仅时间
+    };
+
+public:
+    ValueTags() : m_knownTags(NoTag)
+    {
+
+    }
+
+    bool isEmpty() const
+    {
+        return m_knownTags == NoTag && m_unknownTags.isEmpty();
+    }
+
+    bool testFlag(KnownTag tag) const
+    {
+        return (m_knownTags & tag) != 0;
+    }
+
+    int knownTags() const
+    {
+        return m_knownTags;
+    }
+
+    const QStringList& unknownTags() const
+    {
+        return m_unknownTags;
+    }
+
+    /*! 
+     * 是否含有指定的tag，已知的tag请使用testFlag
+     */
+    bool contains(const QString& tag) const;
+
+    /*! 
+     * 添加一个tag，已知的tag仅设置对应的位标志，不分配字符串
+     */
+    void add(const QStringRef& tag);
+
+    void clear()
+    {
+        m_knownTags = NoTag;
+        m_unknownTags.clear();
+    }
+
+private:
+    int         m_knownTags;                //!< 已知tag的位标志
+    QStringList m_unknownTags;              //!< 未知的tag
+};
+
+/**
+ *  @class StringValueParser
+ *  @brief 字符串值的解析器，可由外部注册以扩展语法
+ *  @note  matches/parse的tags参数已由QStringList改为ValueTags，仍然重写旧版本函数的子类不会被调用，
+ *         重写时请使用Q_DECL_OVERRIDE，由编译器检查签名
+ */
 class StringValueParser : public ValueParser
 {
 public:
@@ -483,12 +592,12 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const
     {
         return ValueParser::matches(metaType);
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const;
 };
 
 class TranslatedStringValueParser : public StringValueParser
@@ -499,15 +608,15 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
-        if (tags.isEmpty() || tags.contains("tr"))
+        if (tags.isEmpty() || tags.testFlag(ValueTags::TrTag))
             return ValueParser::matches(metaType);
 
         return false;
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 
     static QString translate(const QString& string);
 };
@@ -520,12 +629,12 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
         return true;
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 class ObjectContentStringValueParser : public StringValueParser
@@ -542,13 +651,16 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
         // 在解析key时如果遇到枚举，已经将其标识为特殊metaType
         return metaType == QMetaType::Int || metaType == QMetaType::UInt || metaType == EnumNameString;
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
+
+private:
+    mutable QHash<QString, int> m_cachedValues; //!< 仅由类名限定的枚举/标志字符串的解析结果缓存
 };
 
 class PropertyNameStringValueParser : public ObjectContentStringValueParser
@@ -559,13 +671,13 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
         // 考虑到属性的binding，属性字段有可能和任何类型匹配
         return true;
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 class MethodNameStringValueParser : public ObjectContentStringValueParser
@@ -576,13 +688,13 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
         // 考虑到属性的binding，属性字段有可能和任何类型匹配
         return StringValueParser::matches(metaType, tags);
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 class PixmapStringValueParser : public StringValueParser
@@ -593,12 +705,12 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
         return metaType == QMetaType::QPixmap || metaType == QMetaType::QIcon;
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 class SizeStringValueParser : public StringValueParser
@@ -609,7 +721,7 @@ public:
 
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 class RectStringValueParser : public StringValueParser
@@ -620,7 +732,7 @@ public:
 
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 class DateTimeStringValueParser : public StringValueParser
@@ -631,7 +743,7 @@ public:
 
     }
 
-    virtual bool matches(int metaType, const QStringList& tags) const
+    virtual bool matches(int metaType, const ValueTags& tags) const Q_DECL_OVERRIDE
     {
         return 
             metaType == QMetaType::QDateTime || 
@@ -639,7 +751,7 @@ public:
             metaType == QMetaType::QTime;
     }
 
-    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const QStringList& tags) const;
+    virtual QVariant parse(ObjectContext* objectContext, const QString& valueString, const ValueTags& tags) const Q_DECL_OVERRIDE;
 };
 
 #if defined(_MSC_VER)
@@ -0,0 +1,463 @@
+﻿/****************************************Copyright (c)****************************************************
+**
+**                                       D.H. InfoTech
+**
+**--------------File Info---------------------------------------------------------------------------------
+** File name:                  JsonLoaderBenchmark.cpp
+** Latest Version:             V1.0.0
+** Latest modified Date:       2026/10/17
+** Modified by:                
+** Descriptions:               
+**
+**--------------------------------------------------------------------------------------------------------
+** Created by:                 
+** Created date:               2026/10/17
+** Descriptions:               JsonLoader的性能基准测试
+** 
+*********************************************************************************************************/
+#if defined(_MSC_VER) && (_MSC_VER >= 1600)  
+# pragma execution_character_set("utf-8")  
+#endif
+
+#include "Object.h"
+#include "JsonLoader.h"
+
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDebug>
+
+/**
+ *  @class BenchItem
+ *  @brief 基准测试使用的简单对象，包含几种常见类型的属性
+ */
+class BenchItem : public QObject
+{
+    Q_OBJECT
+    Q_ENABLE_COPY(BenchItem)
+
+    Q_PROPERTY(QString text  READ text  WRITE setText)
+    Q_PROPERTY(int     value READ value WRITE setValue)
+    Q_PROPERTY(double  ratio READ ratio WRITE setRatio)
+    Q_PROPERTY(QVariantList values READ values WRITE setValues)
+
+public:
+    BenchItem(QObject* parent = NULL) : QObject(parent), m_value(0), m_ratio(0.0)
+    {
+    }
+
+    QString text() const { return m_text; }
+    void setText(const QString& text) { m_text = text; }
+
+    int value() const { return m_value; }
+    void setValue(int value) { m_value = value; }
+
+    double ratio() const { return m_ratio; }
+    void setRatio(double ratio) { m_ratio = ratio; }
+
+    QVariantList values() const { return m_values; }
+    void setValues(const QVariantList& values) { m_values = values; }
+
+private:
+    QString      m_text;
+    int          m_value;
+    double       m_ratio;
+    QVariantList m_values;
+};
+
+/**
+ *  @struct BenchFixture
+ *  @brief  基准测试的JSON文件规模：每个对象的子对象个数、层数、数组属性的长度及嵌套的JSON文件个数
+ */
+struct BenchFixture
+{
+    const char* name;                       //!< 测试数据行的名称
+    int         width;                      //!< 每个对象的子对象个数
+    int         depth;                      //!< 子对象的层数（不含根对象）
+    int         arraySize;                  //!< 每个对象的数组属性（values）的元素个数
+    int         includeCount;               //!< 根对象下嵌套的JSON文件个数，每个文件包含width个子对象
+};
+
+static const BenchFixture BenchFixtures[] = 
+{
+    { "flat 100",       100,  1,  0,  0 },
+    { "flat 1000",      1000, 1,  0,  0 },
+    { "deep 2^10",      2,    10, 0,  0 },
+    { "screen 14^3",    14,   3,  0,  0 },
+    { "arrays 100x64",  100,  1,  64, 0 },
+    { "includes 10",    10,   1,  0,  10 },
+    { "includes 40",    10,   1,  0,  40 },
+};
+static const int BenchFixtureCount = int(sizeof(BenchFixtures) / sizeof(BenchFixtures[0]));
+
+class JsonLoaderBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    /*! 
+     * 生成一个对象及其子对象树，子对象的id由父对象的id及序号组成
+     * @param[out] json         JSON数据，追加模式
+     * @param[in]  id           对象id
+     * @param[in]  fixture      测试数据的规模
+     * @param[in]  depth        剩余的子对象层数
+     * @param[in]  includes     嵌套的JSON文件路径，追加在子对象之后
+     */
+    static void generateObject(
+        QByteArray& json, const QString& id, const BenchFixture& fixture, int depth, 
+        const QStringList& includes = QStringList()
+        );
+
+    /*! 
+     * 生成一个测试数据的根文件内容，文件头带有注释
+     * @param[in]  index    测试数据序号
+     * @param[in]  dir      嵌套的JSON文件所在的目录
+     * @return     JSON数据
+     */
+    static QByteArray generateJson(int index, const QString& dir);
+
+    /*! 
+     * 测试数据最后一个（最深的）对象的id，用于校验载入结果
+     */
+    static QString lastObjectId(const BenchFixture& fixture);
+
+    /*! 
+     * 测试数据的根文件路径
+     */
+    QString fixtureFile(int index) const;
+
+    /*! 
+     * 卸载载入的对象树，并立即销毁其中的对象，避免在多次迭代中累积
+     */
+    static void unloadRoot(JsonLoader& loader, const QVariant& root);
+
+    /*! 
+     * 添加全部测试数据行，列fixture为测试数据序号
+     */
+    static void addFixtureRows();
+
+private slots:
+    void initTestCase();
+
+    void loadData_data();
+    void loadData();
+
+    void loadFile_data();
+    void loadFile();
+
+    void loadFilePhase_data();
+    void loadFilePhase();
+
+    void lookupWideObject_data();
+    void lookupWideObject();
+
+    void eraseWideObjectKeys_data();
+    void eraseWideObjectKeys();
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+void JsonLoaderBenchmark::generateObject( 
+    QByteArray& json, const QString& id, const BenchFixture& fixture, int depth, const QStringList& includes 
+    )
+{
+    json += QString("{ \".type\": \"BenchItem\", \".id\": \"%1\", \"text\": \"Item %1\", \"value\": %2, \"ratio\": %3")
+        .arg(id)
+        .arg(depth)
+        .arg(depth * 0.5)
+        .toLatin1();
+
+    if (fixture.arraySize > 0)
+    {
+        json += ", \"values\": [";
+        for (int i = 0; i < fixture.arraySize; i++)
+        {
+            json += QByteArray::number(i);
+            if (i + 1 < fixture.arraySize) {
+                json += ", ";
+            }
+        }
+        json += "]";
+    }
+
+    if (depth > 0 || !includes.isEmpty())
+    {
+        json += ",\n\".objects\": [\n";
+        int childCount = depth > 0 ? fixture.width : 0;
+        for (int i = 0; i < childCount; i++)
+        {
+            generateObject(json, QString("%1_%2").arg(id).arg(i), fixture, depth - 1);
+            if (i + 1 < childCount || !includes.isEmpty()) {
+                json += ",";
+            }
+            json += "\n";
+        }
+        for (int i = 0; i < includes.size(); i++)
+        {
+            json += "\"" + includes.at(i).toUtf8() + "\"";
+            if (i + 1 < includes.size()) {
+                json += ",";
+            }
+            json += "\n";
+        }
+        json += "]";
+    }
+    json += " }";
+}
+
+QByteArray JsonLoaderBenchmark::generateJson( int index, const QString& dir )
+{
+    const BenchFixture& fixture = BenchFixtures[index];
+    QStringList includes;
+    for (int i = 0; i < fixture.includeCount; i++) {
+        includes.push_back(dir + QString("/fixture%1_include%2.json").arg(index).arg(i));
+    }
+
+    QByteArray json;
+    json += "// JsonLoader benchmark: ";
+    json += fixture.name;
+    json += "\n";
+    generateObject(json, "n", fixture, fixture.depth, includes);
+    json += "\n";
+    return json;
+}
+
+QString JsonLoaderBenchmark::lastObjectId( const BenchFixture& fixture )
+{
+    if (fixture.includeCount > 0) {
+        return QString("include%1_%2").arg(fixture.includeCount - 1).arg(fixture.width - 1);
+    }
+
+    QString id = "n";
+    for (int i = 0; i < fixture.depth; i++) {
+        id += QString("_%1").arg(fixture.width - 1);
+    }
+    return id;
+}
+
+QString JsonLoaderBenchmark::fixtureFile( int index ) const
+{
+    return m_tempDir.path() + QString("/fixture%1.json").arg(index);
+}
+
+void JsonLoaderBenchmark::unloadRoot( JsonLoader& loader, const QVariant& root )
+{
+    loader.unload(root.value<QObject*>());
+    QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+}
+
+void JsonLoaderBenchmark::addFixtureRows()
+{
+    QTest::addColumn<int>("fixture");
+
+    for (int i = 0; i < BenchFixtureCount; i++) {
+        QTest::newRow(BenchFixtures[i].name) << i;
+    }
+}
+
+void JsonLoaderBenchmark::initTestCase()
+{
+    REGISTER_METATYPE(BenchItem);
+    QVERIFY(m_tempDir.isValid());
+
+    // 各规模的测试文件只生成一次，嵌套的文件使用绝对路径引用
+    for (int i = 0; i < BenchFixtureCount; i++)
+    {
+        const BenchFixture& fixture = BenchFixtures[i];
+        for (int j = 0; j < fixture.includeCount; j++)
+        {
+            QByteArray json = "// JsonLoader benchmark include\n";
+            generateObject(json, QString("include%1").arg(j), fixture, 1);
+
+            QFile file(m_tempDir.path() + QString("/fixture%1_include%2.json").arg(i).arg(j));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            QVERIFY(file.write(json) > 0);
+        }
+
+        QFile file(fixtureFile(i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(generateJson(i, m_tempDir.path())) > 0);
+    }
+}
+
+void JsonLoaderBenchmark::loadData_data()
+{
+    addFixtureRows();
+}
+
+/*! 
+ * 内存中的JSON数据：解析、创建对象上下文树、创建对象、解析属性（嵌套的文件仍从磁盘读取）
+ */
+void JsonLoaderBenchmark::loadData()
+{
+    QFETCH(int, fixture);
+    QByteArray json = generateJson(fixture, m_tempDir.path());
+    // 内存中的数据不经过注释处理
+    json.remove(0, json.indexOf('\n') + 1);
+
+    JsonLoader loader;
+    QBENCHMARK
+    {
+        loader.cleanup();
+        QVariant root = loader.load(json, "bench");
+        unloadRoot(loader, root);
+    }
+}
+
+void JsonLoaderBenchmark::loadFile_data()
+{
+    addFixtureRows();
+}
+
+/*! 
+ * JSON文件：每次迭代前清空缓冲区，包括读取文件及移除注释的开销
+ */
+void JsonLoaderBenchmark::loadFile()
+{
+    QFETCH(int, fixture);
+    QString jsonFile = fixtureFile(fixture);
+
+    JsonLoader loader;
+    QVariant root = loader.load(jsonFile);
+    QVERIFY(root.value<QObject*>() != NULL);
+    QVERIFY(loader.findObject(lastObjectId(BenchFixtures[fixture])) != NULL);
+    unloadRoot(loader, root);
+
+    QBENCHMARK
+    {
+        loader.cleanup();
+        root = loader.load(jsonFile);
+        unloadRoot(loader, root);
+    }
+}
+
+void JsonLoaderBenchmark::loadFilePhase_data()
+{
+    QTest::addColumn<int>("fixture");
+    QTest::addColumn<int>("phase");
+
+    for (int i = 0; i < BenchFixtureCount; i++)
+    {
+        for (int phase = 0; phase < JsonLoader::LoadPhaseCount; phase++)
+        {
+            QByteArray name = QByteArray(BenchFixtures[i].name) + ": " + 
+                JsonLoader::loadPhaseName(JsonLoader::LoadPhase(phase));
+            QTest::newRow(name.constData()) << i << phase;
+        }
+    }
+}
+
+/*! 
+ * JSON文件的分阶段耗时：使用载入统计对各阶段分别计时，以多次载入的平均值作为该阶段的结果
+ */
+void JsonLoaderBenchmark::loadFilePhase()
+{
+    QFETCH(int, fixture);
+    QFETCH(int, phase);
+    QString jsonFile = fixtureFile(fixture);
+
+    JsonLoader loader;
+    QVERIFY(loader.setLoadStatsEnabled(true));
+
+    // 首次载入用于预热（类型信息、属性及方法索引等缓存），不计入结果
+    QVariant root = loader.load(jsonFile);
+    QVERIFY(root.value<QObject*>() != NULL);
+    unloadRoot(loader, root);
+
+    const int iterations = 5;
+    qint64 phaseTime = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        loader.cleanup();
+        root = loader.load(jsonFile);
+        phaseTime += loader.loadPhaseTime(JsonLoader::LoadPhase(phase));
+        unloadRoot(loader, root);
+    }
+
+    QTest::setBenchmarkResult(phaseTime / 1000000.0 / iterations, QTest::WalltimeMilliseconds);
+}
+
+void JsonLoaderBenchmark::lookupWideObject_data()
+{
+    QTest::addColumn<int>("keyCount");
+
+    QTest::newRow("4 keys")  << 4;
+    QTest::newRow("16 keys") << 16;
+    QTest::newRow("64 keys") << 64;
+}
+
+/*! 
+ * Key较多的对象：按Key查找全部子对象上下文
+ */
+void JsonLoaderBenchmark::lookupWideObject()
+{
+    QFETCH(int, keyCount);
+
+    ObjectContext context;
+    QStringList keys;
+    for (int i = 0; i < keyCount; i++)
+    {
+        keys.push_back(QString("key%1").arg(i));
+        context.addChild(keys.back(), new ObjectContext(keys.back(), QJsonValue(i)));
+    }
+
+    int found = 0;
+    QBENCHMARK
+    {
+        foreach (const QString& key, keys)
+        {
+            if (context.constChild(key) != context.constChildEnd()) {
+                found++;
+            }
+        }
+    }
+    QVERIFY(found > 0 && found % keyCount == 0);
+
+    for (KeyObjectContextMapConstIter iter = context.constChildBegin(); iter != context.constChildEnd(); ++iter) {
+        qDeleteAll(iter->second);
+    }
+}
+
+void JsonLoaderBenchmark::eraseWideObjectKeys_data()
+{
+    lookupWideObject_data();
+}
+
+/*! 
+ * Key较多的对象：交替移除、重新添加及查找Key（重新载入时的典型操作），索引不应每次完全重建
+ */
+void JsonLoaderBenchmark::eraseWideObjectKeys()
+{
+    QFETCH(int, keyCount);
+
+    ObjectContext context;
+    QStringList keys;
+    ObjectContextList children;
+    for (int i = 0; i < keyCount; i++)
+    {
+        keys.push_back(QString("key%1").arg(i));
+        children.push_back(new ObjectContext(keys.back(), QJsonValue(i)));
+        context.addChild(keys.back(), children.back());
+    }
+
+    QBENCHMARK
+    {
+        // 移除位于中部的Key后重新添加至末尾，并查找其后的Key
+        for (int i = 0; i < keyCount; i++)
+        {
+            int index = (i * 7) % keyCount;
+            context.removeChild(keys.at(index), children.at(index));
+            context.addChild(keys.at(index), children.at(index));
+            QVERIFY(context.constChild(keys.at((index + 1) % keyCount)) != context.constChildEnd());
+        }
+    }
+
+    foreach (const QString& key, keys) {
+        QVERIFY(context.constChild(key) != context.constChildEnd());
+    }
+    qDeleteAll(children);
+}
+
+QTEST_GUILESS_MAIN(JsonLoaderBenchmark)
+#include "JsonLoaderBenchmark.moc"
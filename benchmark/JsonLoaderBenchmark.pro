@@ -0,0 +1,28 @@
+#-------------------------------------------------------------------------------------------------------
+# JsonLoader的性能基准测试（QtTest/QBENCHMARK），直接编译库的源文件
+# 运行：qmake && make && ./JsonLoaderBenchmark [-iterations N] [-tickcounter|-callgrind]
+# 分阶段耗时：./JsonLoaderBenchmark loadFilePhase
+#-------------------------------------------------------------------------------------------------------
+
+QT       += core widgets testlib
+
+TARGET    = JsonLoaderBenchmark
+CONFIG   += console testcase
+CONFIG   -= app_bundle
+TEMPLATE  = app
+
+DEFINES  += JSON_LOADER_LIBRARY ENABLE_LOAD_PROFILING=1
+
+INCLUDEPATH += ..
+
+HEADERS  += \
+    ../JsonLoader.h \
+    ../JsonLoader_p.h \
+    ../Object.h \
+    ../Parser.h
+
+SOURCES  += \
+    ../JsonLoader.cpp \
+    ../Object.cpp \
+    ../Parser.cpp \
+    JsonLoaderBenchmark.cpp